@@ -8,6 +8,9 @@ include(AbUtilities)
 find_package(Python3 REQUIRED COMPONENTS Interpreter)
 find_package(ClangFormat)
 
+# Data files generated at build time are placed here, and are visible to every template.
+set(AB_GENERATED_DATA_DIR ${CMAKE_BINARY_DIR}/data)
+
 # Add a jinja-generated source file
 # Usage:
 #  ab_add_generated_source(
@@ -26,6 +29,7 @@ function(ab_add_jinja_template)
 		COMMAND
 			${Python3_EXECUTABLE} ${CMAKE_SOURCE_DIR}/scripts/jinja-generate.py
 				--data-dir=${CMAKE_SOURCE_DIR}/data
+				--data-dir=${AB_GENERATED_DATA_DIR}
 				--include-dir=${CMAKE_SOURCE_DIR}/templates
 				${ARG_INPUT}
 				${ARG_OUTPUT}
@@ -53,9 +57,10 @@ function(ab_add_jinja_cxx_template)
 	get_filename_component(ARG_OUTPUT ${ARG_OUTPUT} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_BINARY_DIR})
 
 	ab_add_jinja_template(
-		INPUT      ${ARG_INPUT}
-		OUTPUT     ${ARG_OUTPUT}.dirty
-		DATA_FILES ${ARG_DATA_FILES}
+		INPUT             ${ARG_INPUT}
+		OUTPUT            ${ARG_OUTPUT}.dirty
+		DATA_FILES        ${ARG_DATA_FILES}
+		TEMPLATE_INCLUDES ${ARG_TEMPLATE_INCLUDES}
 	)
 
 	clang_formatx(
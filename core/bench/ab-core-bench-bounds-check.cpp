@@ -0,0 +1,207 @@
+#include <Ab/FuncBuilder.hpp>
+#include <Ab/Interpreter.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/ModuleWriter.hpp>
+#include <Ab/Runtime.hpp>
+#include <Ab/VirtualMachine.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <memory>
+
+/// Compare the linear memory bounds checks, by running the same memory-bound ABX modules under
+/// each. Every module has a one page memory.
+///
+/// Usage: ab-core-bench-bounds-check [<repetitions>]
+///
+
+namespace Ab::Bench {
+
+/// A single function module, and the argument it is benchmarked with.
+///
+struct Program {
+	const char* name;
+	std::shared_ptr<Module> module;
+	std::int32_t arg;
+};
+
+/// Compile a module with a one page memory, and a single i32->i32 function, with a body generated
+/// by a FuncBuilder.
+///
+template <typename F>
+std::shared_ptr<Module> compile_func(Context& cx, std::uint32_t nregs, F&& build) {
+	ModuleNode mod;
+	mod.types.push_back(FuncType({ValType::I32}, {ValType::I32}));
+	mod.memories.push_back(MemoryType{1, 1});
+	FuncNode func;
+	func.type_idx = 0;
+	func.nregs    = nregs;
+
+	FuncBuilder fb;
+	build(fb);
+	func.push<BytecodeInsnNode>(fb.finalize());
+	mod.funcs.push_back(std::move(func));
+
+	return compile(cx, mod.write());
+}
+
+/// Sum the memory as i32s, n times over one word at a time. A load every iteration.
+///
+std::shared_ptr<Module> sum_words(Context& cx) {
+	return compile_func(cx, 3, [](FuncBuilder& fb) {
+		auto loop = fb.make_label();
+		auto done = fb.make_label();
+		fb.emit_x32_const(1, 0);
+		fb.emit_x32_const(2, 0);
+		fb.place(loop);
+		fb.emit_goto_unless(0, done);
+		fb.emit_i32_load(3, 2, 0);
+		fb.emit_i32_add(1, 1, 3);
+		fb.emit_i32_add_ri(2, 2, 4);
+		fb.emit_i32_and_ri(2, 2, 0xfffc);
+		fb.emit_i32_sub_ri(0, 0, 1);
+		fb.emit_goto(loop);
+		fb.place(done);
+		fb.emit_x32_return(1);
+	});
+}
+
+/// Copy the low half of memory into the high half, n i64s at a time. A load and a store every
+/// iteration.
+///
+std::shared_ptr<Module> copy_words(Context& cx) {
+	return compile_func(cx, 3, [](FuncBuilder& fb) {
+		auto loop = fb.make_label();
+		auto done = fb.make_label();
+		fb.emit_x32_const(1, 0);
+		fb.place(loop);
+		fb.emit_goto_unless(0, done);
+		fb.emit_i64_load(2, 1, 0);
+		fb.emit_i64_store(1, 0x8000, 2);
+		fb.emit_i32_add_ri(1, 1, 8);
+		fb.emit_i32_and_ri(1, 1, 0x7ff8);
+		fb.emit_i32_sub_ri(0, 0, 1);
+		fb.emit_goto(loop);
+		fb.place(done);
+		fb.emit_x32_return(1);
+	});
+}
+
+/// Count n pseudo-random bytes into a histogram of i32 buckets. Dependent loads and stores to
+/// scattered addresses.
+///
+std::shared_ptr<Module> histogram(Context& cx) {
+	return compile_func(cx, 3, [](FuncBuilder& fb) {
+		auto loop = fb.make_label();
+		auto done = fb.make_label();
+		fb.emit_x32_const(1, 12345);
+		fb.place(loop);
+		fb.emit_goto_unless(0, done);
+		fb.emit_i32_mul_ri(1, 1, 1103515245);
+		fb.emit_i32_add_ri(1, 1, 12345);
+		fb.emit_i32_shr_u_ri(2, 1, 16);
+		fb.emit_i32_and_ri(2, 2, 0x3fc);
+		fb.emit_i32_load(3, 2, 0);
+		fb.emit_i32_add_ri(3, 3, 1);
+		fb.emit_i32_store(2, 0, 3);
+		fb.emit_i32_sub_ri(0, 0, 1);
+		fb.emit_goto(loop);
+		fb.place(done);
+		fb.emit_i32_load(1, 2, 0);
+		fb.emit_x32_return(1);
+	});
+}
+
+/// Run the program once, and return the elapsed time in nanoseconds.
+///
+std::int64_t run_once(Context& cx, ModuleInst* inst, std::int32_t arg, std::int32_t& result) {
+	auto start = std::chrono::steady_clock::now();
+	auto ret   = static_call<std::int32_t>(cx, inst->func_inst(0), arg);
+	auto end   = std::chrono::steady_clock::now();
+	result     = std::get<0>(ret);
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/// The best time of several runs, under the given bounds check. The program is instantiated with
+/// a fresh memory for each bounds check.
+///
+std::int64_t best_of(Context& cx, const Program& program, BoundsCheck bounds_check, int reps,
+	std::int32_t& result) {
+	ModuleInst* inst = instantiate(cx, program.module, DEFAULT_DISPATCH, bounds_check);
+
+	std::int64_t best = run_once(cx, inst, program.arg, result);
+	for (int i = 1; i < reps; ++i) {
+		std::int64_t t = run_once(cx, inst, program.arg, result);
+		if (t < best) {
+			best = t;
+		}
+	}
+	return best;
+}
+
+int run(int reps) {
+	AutoRuntime runtime;
+	VirtualMachine vm(&runtime);
+	Context cx(&vm);
+
+	const Program programs[] = {
+		{"sum_words", sum_words(cx), 10'000'000},
+		{"copy_words", copy_words(cx), 10'000'000},
+		{"histogram", histogram(cx), 10'000'000},
+	};
+
+	constexpr BoundsCheck bounds_checks[] = {
+		BoundsCheck::GUARD_REGION,
+		BoundsCheck::EXPLICIT,
+		BoundsCheck::MASK,
+	};
+
+	fmt::print("{:<12} {:>16} {:>16} {:>16}\n", "program", cstring(bounds_checks[0]),
+		cstring(bounds_checks[1]), cstring(bounds_checks[2]));
+
+	int status = 0;
+
+	for (const auto& program : programs) {
+		std::int32_t results[3] = {};
+		std::int64_t times[3]   = {};
+
+		for (std::size_t i = 0; i < 3; ++i) {
+			times[i] = best_of(cx, program, bounds_checks[i], reps, results[i]);
+		}
+
+		fmt::print("{:<12} {:>13.3f} ms {:>13.3f} ms {:>13.3f} ms\n", program.name, times[0] / 1e6,
+			times[1] / 1e6, times[2] / 1e6);
+
+		for (std::size_t i = 1; i < 3; ++i) {
+			if (results[i] != results[0]) {
+				fmt::print(stderr, "error: {}: results differ: {} != {}\n", program.name,
+					results[i], results[0]);
+				status = 1;
+			}
+		}
+	}
+
+	return status;
+}
+
+}  // namespace Ab::Bench
+
+extern "C" int main(int argc, char** argv) {
+	int reps = 5;
+
+	if (argc > 1) {
+		reps = std::atoi(argv[1]);
+	}
+
+	if (reps < 1) {
+		fmt::print(stderr, "Usage: {} [<repetitions>]\n", argv[0]);
+		return 1;
+	}
+
+	return Ab::Bench::run(reps);
+}
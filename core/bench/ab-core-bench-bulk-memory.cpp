@@ -0,0 +1,134 @@
+#include <Ab/BulkMemory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+#include <vector>
+
+/// Compare the bulk memory kernels, by copying and filling buffers of increasing size with each.
+/// Reports throughput in GiB/s. Buffers past the non-temporal threshold are stored around the
+/// cache.
+///
+/// Usage: ab-core-bench-bulk-memory [<repetitions>]
+///
+
+namespace Ab::Bench {
+
+constexpr BulkMemoryKernel kernels[] = {
+	BulkMemoryKernel::GENERIC,
+	BulkMemoryKernel::SSE2,
+	BulkMemoryKernel::AVX2,
+	BulkMemoryKernel::AVX512,
+};
+
+constexpr std::size_t sizes[] = {
+	kibibytes(1),
+	kibibytes(16),
+	kibibytes(256),
+	mebibytes(4),
+	mebibytes(64),
+};
+
+/// Run f reps times over, and return the best time in nanoseconds.
+///
+template <typename F>
+std::int64_t best_of(int reps, F&& f) {
+	std::int64_t best = 0;
+	for (int i = 0; i < reps; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		f();
+		auto end       = std::chrono::steady_clock::now();
+		std::int64_t t = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		if (i == 0 || t < best) {
+			best = t;
+		}
+	}
+	return best;
+}
+
+/// Repeat an operation on a buffer of the given size until it has moved at least this many bytes,
+/// so small buffers are timed over many calls.
+///
+constexpr std::size_t BYTES_PER_RUN = mebibytes(256);
+
+double gib_per_second(std::size_t bytes, std::int64_t ns) {
+	return (double(bytes) / double(gibibytes(1))) / (double(ns) / 1e9);
+}
+
+int run(int reps) {
+	fmt::print("{:<6} {:>10}", "op", "size");
+	for (BulkMemoryKernel kernel : kernels) {
+		fmt::print(" {:>12}", cstring(kernel));
+	}
+	fmt::print("\n");
+
+	int status = 0;
+
+	for (std::size_t size : sizes) {
+		std::vector<Byte> src(size);
+		std::vector<Byte> dst(size);
+		for (std::size_t i = 0; i < size; ++i) {
+			src[i] = Byte(i);
+		}
+
+		std::size_t calls = std::max<std::size_t>(1, BYTES_PER_RUN / size);
+		std::size_t bytes = calls * size;
+
+		fmt::print("{:<6} {:>10}", "copy", size);
+		for (BulkMemoryKernel kernel : kernels) {
+			if (!supports(kernel)) {
+				fmt::print(" {:>12}", "-");
+				continue;
+			}
+			std::int64_t t = best_of(reps, [&] {
+				for (std::size_t i = 0; i < calls; ++i) {
+					copy_bytes(kernel, dst.data(), src.data(), size);
+				}
+			});
+			fmt::print(" {:>7.2f} GiB/s", gib_per_second(bytes, t));
+			if (dst != src) {
+				fmt::print(stderr, "error: {}: copy of {} bytes differs\n", cstring(kernel), size);
+				status = 1;
+			}
+		}
+		fmt::print("\n");
+
+		fmt::print("{:<6} {:>10}", "fill", size);
+		for (BulkMemoryKernel kernel : kernels) {
+			if (!supports(kernel)) {
+				fmt::print(" {:>12}", "-");
+				continue;
+			}
+			std::int64_t t = best_of(reps, [&] {
+				for (std::size_t i = 0; i < calls; ++i) {
+					fill_bytes(kernel, dst.data(), Byte(i), size);
+				}
+			});
+			fmt::print(" {:>7.2f} GiB/s", gib_per_second(bytes, t));
+		}
+		fmt::print("\n");
+	}
+
+	return status;
+}
+
+}  // namespace Ab::Bench
+
+extern "C" int main(int argc, char** argv) {
+	int reps = 5;
+
+	if (argc > 1) {
+		reps = std::atoi(argv[1]);
+	}
+
+	if (reps < 1) {
+		fmt::print(stderr, "Usage: {} [<repetitions>]\n", argv[0]);
+		return 1;
+	}
+
+	return Ab::Bench::run(reps);
+}
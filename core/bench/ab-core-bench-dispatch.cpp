@@ -0,0 +1,191 @@
+#include <Ab/FuncBuilder.hpp>
+#include <Ab/Interpreter.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/ModuleWriter.hpp>
+#include <Ab/Runtime.hpp>
+#include <Ab/VirtualMachine.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <memory>
+
+/// Compare the interpreter's dispatch strategies, by running the same ABX modules under each.
+///
+/// Usage: ab-core-bench-dispatch [<repetitions>]
+///
+
+namespace Ab::Bench {
+
+/// A single function module, and the argument it is benchmarked with.
+///
+struct Program {
+	const char* name;
+	std::shared_ptr<Module> module;
+	std::int32_t arg;
+};
+
+/// Compile a module with a single i32->i32 function, with a body generated by a FuncBuilder.
+///
+template <typename F>
+std::shared_ptr<Module> compile_func(Context& cx, std::uint32_t nregs, F&& build) {
+	ModuleNode mod;
+	mod.types.push_back(FuncType({ValType::I32}, {ValType::I32}));
+	FuncNode func;
+	func.type_idx = 0;
+	func.nregs    = nregs;
+
+	FuncBuilder fb;
+	build(fb);
+	func.push<BytecodeInsnNode>(fb.finalize());
+	mod.funcs.push_back(std::move(func));
+
+	return compile(cx, mod.write());
+}
+
+/// Sum the integers from n down to 1. Short handlers, and a backwards branch every iteration.
+///
+std::shared_ptr<Module> sum_loop(Context& cx) {
+	return compile_func(cx, 2, [](FuncBuilder& fb) {
+		auto loop = fb.make_label();
+		auto done = fb.make_label();
+		fb.emit_x32_const(1, 0);
+		fb.emit_x32_const(2, 1);
+		fb.place(loop);
+		fb.emit_goto_unless(0, done);
+		fb.emit_i32_add(1, 1, 0);
+		fb.emit_i32_sub(0, 0, 2);
+		fb.emit_goto(loop);
+		fb.place(done);
+		fb.emit_x32_return(1);
+	});
+}
+
+/// Recursive fibonacci. Dominated by calls and returns.
+///
+std::shared_ptr<Module> fib(Context& cx) {
+	return compile_func(cx, 4, [](FuncBuilder& fb) {
+		auto recurse = fb.make_label();
+		fb.emit_x32_const(1, 2);
+		fb.emit_i32_lt_s(2, 0, 1);
+		fb.emit_goto_unless(2, recurse);
+		fb.emit_x32_return(0);
+		fb.place(recurse);
+		fb.emit_x32_const(1, 1);
+		fb.emit_i32_sub(4, 0, 1);
+		fb.emit_call(0, 4);
+		fb.emit_load_result_x32(3);
+		fb.emit_x32_const(1, 2);
+		fb.emit_i32_sub(4, 0, 1);
+		fb.emit_call(0, 4);
+		fb.emit_load_result_x32(4);
+		fb.emit_i32_add(3, 3, 4);
+		fb.emit_x32_return(3);
+	});
+}
+
+/// A linear congruential generator, iterated n times. Longer straight-line blocks.
+///
+std::shared_ptr<Module> lcg_loop(Context& cx) {
+	return compile_func(cx, 5, [](FuncBuilder& fb) {
+		auto loop = fb.make_label();
+		auto done = fb.make_label();
+		fb.emit_x32_const(1, 12345);
+		fb.emit_x32_const(2, 1103515245);
+		fb.emit_x32_const(3, 1);
+		fb.emit_x32_const(4, 16);
+		fb.place(loop);
+		fb.emit_goto_unless(0, done);
+		fb.emit_i32_mul(1, 1, 2);
+		fb.emit_i32_add(1, 1, 3);
+		fb.emit_i32_shr_u(5, 1, 4);
+		fb.emit_i32_xor(1, 1, 5);
+		fb.emit_i32_sub(0, 0, 3);
+		fb.emit_goto(loop);
+		fb.place(done);
+		fb.emit_x32_return(1);
+	});
+}
+
+/// Run the program once, and return the elapsed time in nanoseconds.
+///
+std::int64_t run_once(Context& cx, ModuleInst* inst, std::int32_t arg, std::int32_t& result) {
+	auto start = std::chrono::steady_clock::now();
+	auto ret   = static_call<std::int32_t>(cx, inst->func_inst(0), arg);
+	auto end   = std::chrono::steady_clock::now();
+	result     = std::get<0>(ret);
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+/// The best time of several runs, under the given dispatch strategy.
+/// The program is instantiated, and threaded, for each strategy.
+///
+std::int64_t best_of(Context& cx, const Program& program, Dispatch dispatch, int reps,
+	std::int32_t& result) {
+	ModuleInst* inst = instantiate(cx, program.module, dispatch);
+
+	std::int64_t best = run_once(cx, inst, program.arg, result);
+	for (int i = 1; i < reps; ++i) {
+		std::int64_t t = run_once(cx, inst, program.arg, result);
+		if (t < best) {
+			best = t;
+		}
+	}
+	return best;
+}
+
+int run(int reps) {
+	AutoRuntime runtime;
+	VirtualMachine vm(&runtime);
+	Context cx(&vm);
+
+	const Program programs[] = {
+		{"sum_loop", sum_loop(cx), 10'000'000},
+		{"fib", fib(cx), 27},
+		{"lcg_loop", lcg_loop(cx), 10'000'000},
+	};
+
+	fmt::print("{:<10} {:>16} {:>16} {:>8}\n", "program", cstring(Dispatch::COMPUTED_GOTO),
+		cstring(Dispatch::TAIL_CALL), "ratio");
+
+	int status = 0;
+
+	for (const auto& program : programs) {
+		std::int32_t goto_result = 0;
+		std::int32_t tail_result = 0;
+
+		auto goto_ns = best_of(cx, program, Dispatch::COMPUTED_GOTO, reps, goto_result);
+		auto tail_ns = best_of(cx, program, Dispatch::TAIL_CALL, reps, tail_result);
+
+		fmt::print("{:<10} {:>13.3f} ms {:>13.3f} ms {:>8.3f}\n", program.name, goto_ns / 1e6,
+			tail_ns / 1e6, double(tail_ns) / double(goto_ns));
+
+		if (goto_result != tail_result) {
+			fmt::print(stderr, "error: {}: results differ: {} != {}\n", program.name,
+				goto_result, tail_result);
+			status = 1;
+		}
+	}
+
+	return status;
+}
+
+}  // namespace Ab::Bench
+
+extern "C" int main(int argc, char** argv) {
+	int reps = 5;
+
+	if (argc > 1) {
+		reps = std::atoi(argv[1]);
+	}
+
+	if (reps < 1) {
+		fmt::print(stderr, "Usage: {} [<repetitions>]\n", argv[0]);
+		return 1;
+	}
+
+	return Ab::Bench::run(reps);
+}
@@ -0,0 +1,139 @@
+#include <Ab/Latch.hpp>
+#include <Ab/Synchronic.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Measure wake-up latency. Two threads hand a token back and forth, each waiting for the other.
+/// Reports the mean time of one handoff, for a condition variable, and for a Synchronic under
+/// each WaitHint. Also times two threads meeting at a Latch, round after round.
+///
+/// Usage: ab-core-bench-wakeup [<repetitions>]
+///
+
+namespace Ab::Bench {
+
+constexpr std::uint64_t HANDOFFS = 100'000;
+
+/// Run f reps times over, and return the best time in nanoseconds.
+///
+template <typename F>
+std::int64_t best_of(int reps, F&& f) {
+	std::int64_t best = 0;
+	for (int i = 0; i < reps; ++i) {
+		auto start = std::chrono::steady_clock::now();
+		f();
+		auto end       = std::chrono::steady_clock::now();
+		std::int64_t t = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		if (i == 0 || t < best) {
+			best = t;
+		}
+	}
+	return best;
+}
+
+void ping_pong_condvar() {
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::uint64_t token = 0;
+
+	auto play = [&](std::uint64_t first) {
+		for (std::uint64_t i = first; i < HANDOFFS; i += 2) {
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [&] { return token == i; });
+			token = i + 1;
+			changed.notify_one();
+		}
+	};
+
+	std::thread other(play, 1);
+	play(0);
+	other.join();
+}
+
+void ping_pong_synchronic(WaitHint hint) {
+	Synchronic<std::uint64_t> token(0);
+
+	auto play = [&](std::uint64_t first) {
+		for (std::uint64_t i = first; i < HANDOFFS; i += 2) {
+			token.wait_for(i, hint);
+			token.store(i + 1);
+		}
+	};
+
+	std::thread other(play, 1);
+	play(0);
+	other.join();
+}
+
+/// Two threads meet at a latch, one round at a time.
+///
+constexpr std::uint64_t LATCH_ROUNDS = 100'000;
+
+void latch_rounds(WaitHint hint) {
+	std::vector<std::unique_ptr<Latch>> latches;
+	for (std::uint64_t i = 0; i < LATCH_ROUNDS; ++i) {
+		latches.push_back(std::make_unique<Latch>(2));
+	}
+
+	auto play = [&] {
+		for (auto& latch : latches) {
+			latch->arrive_and_wait(1, hint);
+		}
+	};
+
+	std::thread other(play);
+	play();
+	other.join();
+}
+
+int run(int reps) {
+	fmt::print("{:<32} {:>12}\n", "handoff", "ns/handoff");
+
+	auto report = [&](const char* name, auto&& f) {
+		std::int64_t t = best_of(reps, f);
+		fmt::print("{:<32} {:>12.1f}\n", name, double(t) / double(HANDOFFS));
+	};
+
+	report("condition_variable", [] { ping_pong_condvar(); });
+	report("synchronic/optimize_utilization",
+		[] { ping_pong_synchronic(WaitHint::OPTIMIZE_UTILIZATION); });
+	report("synchronic/optimize_latency", [] { ping_pong_synchronic(WaitHint::OPTIMIZE_LATENCY); });
+
+	fmt::print("\n{:<32} {:>12}\n", "latch", "ns/round");
+
+	auto report_latch = [&](const char* name, WaitHint hint) {
+		std::int64_t t = best_of(reps, [&] { latch_rounds(hint); });
+		fmt::print("{:<32} {:>12.1f}\n", name, double(t) / double(LATCH_ROUNDS));
+	};
+
+	report_latch("latch/optimize_utilization", WaitHint::OPTIMIZE_UTILIZATION);
+	report_latch("latch/optimize_latency", WaitHint::OPTIMIZE_LATENCY);
+
+	return 0;
+}
+
+}  // namespace Ab::Bench
+
+extern "C" int main(int argc, char** argv) {
+	int reps = 5;
+
+	if (argc > 1) {
+		reps = std::atoi(argv[1]);
+	}
+
+	if (reps < 1) {
+		fmt::print(stderr, "Usage: {} [<repetitions>]\n", argv[0]);
+		return 1;
+	}
+
+	return Ab::Bench::run(reps);
+}
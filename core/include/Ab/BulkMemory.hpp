@@ -0,0 +1,93 @@
+#ifndef AB_BULKMEMORY_HPP_
+#define AB_BULKMEMORY_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Bytes.hpp>
+#include <cstddef>
+#include <cstring>
+
+namespace Ab {
+
+/// The vector kernels behind the bulk memory operators. The widest kernel the CPU supports is
+/// selected once, at startup, and used for ranges too large to cache. Anything smaller is left to
+/// memmove and memset, which are already tuned for cached data. See ab-core-bench-bulk-memory.
+///
+enum class BulkMemoryKernel {
+	/// memmove and memset.
+	///
+	GENERIC,
+
+	/// 16-byte vectors.
+	///
+	SSE2,
+
+	/// 32-byte vectors.
+	///
+	AVX2,
+
+	/// 64-byte vectors.
+	///
+	AVX512,
+};
+
+constexpr const char* cstring(BulkMemoryKernel kernel) noexcept {
+	switch (kernel) {
+	case BulkMemoryKernel::GENERIC:
+		return "generic";
+	case BulkMemoryKernel::SSE2:
+		return "sse2";
+	case BulkMemoryKernel::AVX2:
+		return "avx2";
+	case BulkMemoryKernel::AVX512:
+		return "avx512";
+	default:
+		return "unknown";
+	}
+}
+
+/// Copies and fills of at least this many bytes use non-temporal stores, which bypass the cache
+/// rather than evict the working set for data that won't be read again soon. Below this size,
+/// cached stores are faster.
+///
+constexpr std::size_t BULK_MEMORY_NON_TEMPORAL_SIZE = mebibytes(16);
+
+/// True if the CPU supports a kernel.
+///
+bool supports(BulkMemoryKernel kernel) noexcept;
+
+/// The kernel used by copy_bytes and fill_bytes.
+///
+BulkMemoryKernel bulk_memory_kernel() noexcept;
+
+/// Copy n bytes from src to dst with a specific kernel, which the CPU must support. The ranges may
+/// overlap.
+///
+void copy_bytes(BulkMemoryKernel kernel, Byte* dst, const Byte* src, std::size_t n) noexcept;
+
+/// Set n bytes at dst to value, with a specific kernel, which the CPU must support.
+///
+void fill_bytes(BulkMemoryKernel kernel, Byte* dst, Byte value, std::size_t n) noexcept;
+
+/// Copy n bytes from src to dst. The ranges may overlap, as with memmove.
+///
+inline void copy_bytes(Byte* dst, const Byte* src, std::size_t n) noexcept {
+	if (n < BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		std::memmove(dst, src, n);
+	} else {
+		copy_bytes(bulk_memory_kernel(), dst, src, n);
+	}
+}
+
+/// Set n bytes at dst to value, as with memset.
+///
+inline void fill_bytes(Byte* dst, Byte value, std::size_t n) noexcept {
+	if (n < BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		std::memset(dst, value, n);
+	} else {
+		fill_bytes(bulk_memory_kernel(), dst, value, n);
+	}
+}
+
+}  // namespace Ab
+
+#endif  // AB_BULKMEMORY_HPP_
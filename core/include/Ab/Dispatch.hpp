@@ -0,0 +1,43 @@
+#ifndef AB_DISPATCH_HPP_
+#define AB_DISPATCH_HPP_
+
+#include <Ab/Config.hpp>
+
+namespace Ab {
+
+/// How the interpreter transfers control from one instruction handler to the next.
+/// Threaded code holds handler addresses, so it is specific to one strategy, which is chosen when
+/// a module is instantiated.
+///
+enum class Dispatch {
+	/// One function, with a label per handler. Handlers end in an indirect goto.
+	///
+	COMPUTED_GOTO,
+
+	/// One function per handler. Handlers end in a tail call to the next handler.
+	///
+	TAIL_CALL,
+};
+
+/// The dispatch strategy selected at build time, by AB_INTERPRETER_DISPATCH.
+///
+#ifdef AB_INTERPRETER_TAIL_CALL
+constexpr Dispatch DEFAULT_DISPATCH = Dispatch::TAIL_CALL;
+#else
+constexpr Dispatch DEFAULT_DISPATCH = Dispatch::COMPUTED_GOTO;
+#endif
+
+constexpr const char* cstring(Dispatch dispatch) noexcept {
+	switch (dispatch) {
+	case Dispatch::COMPUTED_GOTO:
+		return "computed-goto";
+	case Dispatch::TAIL_CALL:
+		return "tail-call";
+	default:
+		return "unknown";
+	}
+}
+
+}  // namespace Ab
+
+#endif  // AB_DISPATCH_HPP_
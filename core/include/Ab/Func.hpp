@@ -3,6 +3,8 @@
 
 #include <Ab/Config.hpp>
 #include <Ab/Address.hpp>
+#include <Ab/Bytes.hpp>
+#include <Ab/Dispatch.hpp>
 #include <Ab/Types.hpp>
 #include <cstddef>
 #include <span>
@@ -13,6 +15,7 @@ namespace Ab {
 
 class Func;
 class FuncInst;
+class LinearMemory;
 
 struct FuncRef {};
 
@@ -22,12 +25,41 @@ struct IntraModuleFuncRef {};
 
 struct RefTable {};
 
+/// A data segment of an instance. A view of the module's bytes, emptied by `data.drop`.
+///
+struct DataSegment {
+	std::span<const Byte> bytes;
+};
+
 /// Instantiated and fully resolved set of constants.
 ///
 struct ConstPool {
 	std::vector<FuncInst*> func_table;
-	std::vector<float> f32_table;
-	std::vector<double> f64_table;
+	std::vector<const FuncType*> type_table;
+	std::vector<std::uint64_t*> global_table;
+	std::span<const float> f32_table;   ///< A view of the module's table, which never changes.
+	std::span<const double> f64_table;  ///< A view of the module's table, which never changes.
+	std::vector<DataSegment*> data_table;
+	LinearMemory* memory = nullptr;  ///< The module's linear memory, or null.
+	Byte* memory_base    = nullptr;  ///< The base of the linear memory, which never moves.
+	std::uint64_t memory_mask = 0;   ///< The address mask of a masked memory.
+};
+
+/// The stack usage of a function, found by analyzing the module when it is loaded.
+///
+/// Frames are a fixed size, so a function's own stack usage is known up front. A function that
+/// only makes direct calls into non-recursive functions has a bounded stack depth: it's own frame,
+/// plus the deepest of it's callees.
+///
+struct FrameInfo {
+	/// Bytes taken by a frame of the function, including it's registers.
+	///
+	std::uint32_t frame_size = 0;
+
+	/// The most stack the function, and everything it calls, can take. Zero if unbounded, when the
+	/// function may recurse or makes an indirect call.
+	///
+	std::uint32_t max_depth = 0;
 };
 
 /// VM Function. Shared data across multiple instantiations.
@@ -35,13 +67,13 @@ struct ConstPool {
 ///
 class Func {
 public:
-	Func(const FuncType* type, Byte* body, std::size_t var_nregs) noexcept
+	Func(const FuncType* type, std::span<Byte> body, std::size_t var_nregs) noexcept
 		: type_(type)
 		, var_nregs_(var_nregs)
 		, arg_nregs_(type->arg_nregs())
 		, ret_nregs_(type->ret_nregs())
 		, nregs_(var_nregs_ + arg_nregs_)
-		, body_(body, std::size_t(0)) {}
+		, body_(body) {}
 
 	/// Pointer to the underlying type of the function.
 	///
@@ -71,6 +103,16 @@ public:
 	///
 	Byte* body() const noexcept { return body_.data(); }
 
+	/// The complete function body.
+	///
+	std::span<Byte> body_bytes() const noexcept { return body_; }
+
+	/// The stack usage of the function. Filled in by the loader.
+	///
+	FrameInfo& frame_info() noexcept { return frame_info_; }
+
+	const FrameInfo& frame_info() const noexcept { return frame_info_; }
+
 private:
 	const FuncType* type_;
 	std::uint32_t var_nregs_;
@@ -78,6 +120,7 @@ private:
 	std::uint32_t ret_nregs_;
 	std::uint32_t nregs_;
 	std::span<Byte> body_;
+	FrameInfo frame_info_;
 };
 
 /// An instantiated function.
@@ -85,32 +128,31 @@ private:
 ///
 class FuncInst {
 public:
-	FuncInst(Func* base) noexcept
+	FuncInst(Func* base, Byte* body, Dispatch dispatch) noexcept
 		: base_(base)
 		, arg_nregs_(base->arg_nregs())
 		, ret_nregs_(base->ret_nregs())
 		, var_nregs_(base->var_nregs())
 		, nregs_(base->nregs())
-		, body_(base->body()) {}
+		, frame_size_(base->frame_info().frame_size)
+		, max_depth_(base->frame_info().max_depth)
+		, body_(body)
+		, dispatch_(dispatch) {}
 
-	FuncInst(Func* base, const ConstPool& const_pool) noexcept
+	/// A function of a module instance, resolving it's constants through the instance's pool.
+	///
+	FuncInst(Func* base, Byte* body, Dispatch dispatch, const ConstPool* const_pool) noexcept
 		: base_(base)
 		, arg_nregs_(base->arg_nregs())
 		, ret_nregs_(base->ret_nregs())
 		, var_nregs_(base->var_nregs())
 		, nregs_(base->nregs())
-		, body_(base->body())
+		, frame_size_(base->frame_info().frame_size)
+		, max_depth_(base->frame_info().max_depth)
+		, body_(body)
+		, dispatch_(dispatch)
 		, const_pool_(const_pool) {}
 
-	FuncInst(Func* base, ConstPool&& const_pool) noexcept
-		: base_(base)
-		, arg_nregs_(base->arg_nregs())
-		, ret_nregs_(base->ret_nregs())
-		, var_nregs_(base->var_nregs())
-		, nregs_(base->nregs())
-		, body_(base->body())
-		, const_pool_(std::move(const_pool)) {}
-
 	/// Pointer to the underlying function data, which is shared across instances.
 	///
 	const Func* base() const noexcept { return base_; }
@@ -139,16 +181,36 @@ public:
 	///
 	std::uint32_t nreg_bytes() const noexcept { return nregs_ * 4; }
 
-	/// Pointer to the beginning of the function bytecodes.
+	/// Bytes taken by a frame of the function, including it's registers.
+	///
+	std::uint32_t frame_size() const noexcept { return frame_size_; }
+
+	/// The most stack the function, and everything it calls, can take. Zero if unbounded.
+	///
+	std::uint32_t max_depth() const noexcept { return max_depth_; }
+
+	/// The free stack required to call the function from native code. When the stack depth is
+	/// bounded, this covers every call below the function.
+	///
+	std::uint32_t stack_reserve() const noexcept {
+		return max_depth_ != 0 ? max_depth_ : frame_size_;
+	}
+
+	/// Pointer to the beginning of the function's threaded code. See Threading.hpp.
+	/// The original bytecode is available through base().
 	///
 	Byte* body() const noexcept { return body_; }
 
-	ConstPool& const_pool() noexcept { return const_pool_; }
+	/// The dispatch strategy the body was threaded for.
+	///
+	Dispatch dispatch() const noexcept { return dispatch_; }
 
-	const ConstPool& const_pool() const noexcept { return const_pool_; }
+	/// The constant pool of the function's module instance, shared by every function in it.
+	///
+	const ConstPool& const_pool() const noexcept { return *const_pool_; }
 
 	FuncInst* func_const(std::size_t index) const noexcept {
-		return const_pool_.func_table[index];
+		return const_pool_->func_table[index];
 	}
 
 private:
@@ -172,11 +234,25 @@ private:
 	///
 	std::uint32_t nregs_;
 
-	/// Pointer into the code section, after the declaration of the registers.
+	/// Size of the function's frame. Cached for locality.
+	///
+	std::uint32_t frame_size_;
+
+	/// The stack depth of the function, or zero if unbounded. Cached for locality.
+	///
+	std::uint32_t max_depth_;
+
+	/// Pointer into the module instance's threaded code.
 	///
 	Byte* body_;
 
-	ConstPool const_pool_;
+	/// The dispatch strategy the body was threaded for.
+	///
+	Dispatch dispatch_;
+
+	/// The constants of the module instance. Owned by the instance.
+	///
+	const ConstPool* const_pool_ = nullptr;
 };
 
 }  // namespace Ab
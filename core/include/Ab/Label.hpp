@@ -68,6 +68,17 @@ public:
 		return record.offset;
 	}
 
+	/// Move every placed label. `f` maps the old offset of a label to it's new offset.
+	///
+	template <typename F>
+	void relocate(F&& f) {
+		for (auto& record : records_) {
+			if (record.placed) {
+				record.offset = f(record.offset);
+			}
+		}
+	}
+
 private:
 	/// get the next unallocated label id.
 	LabelId next() const { return records_.size(); }
@@ -7,7 +7,17 @@
 #include <Ab/Bytes.hpp>
 #include <Ab/Page.hpp>
 #include <Ab/Result.hpp>
+#include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <fcntl.h>
+#include <mutex>
+#include <span>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
 
 namespace Ab {
 
@@ -15,45 +25,177 @@ class LinearMemoryError : public std::runtime_error {
 	using std::runtime_error::runtime_error;
 };
 
+/// How loads and stores keep within a linear memory. The interpreter has a specialized handler for
+/// every memory access under every strategy, chosen when the code is threaded, so the strategy
+/// costs no branch at run time.
+///
+enum class BoundsCheck : std::uint8_t {
+	/// Reserve the whole 32-bit index space, followed by a guard region as large as the largest
+	/// offset. Every address a load or store can form falls inside the reservation, and any access
+	/// past the end of the memory faults, rather than being checked. Needs 8GiB of address space
+	/// per memory.
+	///
+	GUARD_REGION,
+
+	/// Compare every access against the size of the memory. Reserves only the maximum size.
+	///
+	EXPLICIT,
+
+	/// Mask every address into a power-of-two reservation covering the maximum size. An access
+	/// past the end of the memory, but within the reservation, faults. An access past the
+	/// reservation wraps around, rather than trapping: memory safe, but not exact.
+	///
+	MASK,
+};
+
+constexpr std::size_t BOUNDS_CHECK_COUNT = 3;
+
+/// The bounds check selected at build time, by AB_BOUNDS_CHECK.
+///
+#if defined(AB_BOUNDS_CHECK_EXPLICIT)
+constexpr BoundsCheck DEFAULT_BOUNDS_CHECK = BoundsCheck::EXPLICIT;
+#elif defined(AB_BOUNDS_CHECK_MASK)
+constexpr BoundsCheck DEFAULT_BOUNDS_CHECK = BoundsCheck::MASK;
+#else
+constexpr BoundsCheck DEFAULT_BOUNDS_CHECK = BoundsCheck::GUARD_REGION;
+#endif
+
+constexpr const char* cstring(BoundsCheck bounds_check) noexcept {
+	switch (bounds_check) {
+	case BoundsCheck::GUARD_REGION:
+		return "guard-region";
+	case BoundsCheck::EXPLICIT:
+		return "explicit";
+	case BoundsCheck::MASK:
+		return "mask";
+	default:
+		return "unknown";
+	}
+}
+
 struct LinearMemoryConfig {
 	MutAddress address         = nullptr;
 	std::size_t page_count_min = 1;
 	std::size_t page_count_max = 4;
 
+	/// How accesses to the memory are bounds checked, which determines the size of the reservation.
+	///
+	BoundsCheck bounds_check = BoundsCheck::EXPLICIT;
+
+	/// The fewest pages committed at once, when an explicitly checked memory grows. See
+	/// LinearMemory::grow.
+	///
+	std::size_t commit_chunk = 16;
+
+	/// Fault in pages as they are committed, rather than on first touch.
+	///
+	bool prefault = false;
+
+	/// Back the memory with huge pages. A memory is committed and protected a 64KiB page at a
+	/// time, finer than a huge page, which the hugetlbfs pool can't map. Explicit huge pages are
+	/// treated as transparent. The reservation is aligned to a huge page, and the address hint is
+	/// ignored.
+	///
+	HugePages huge_pages = HugePages::NONE;
+
 	void verify() const {
 		if (page_count_max < page_count_min) {
 			throw LinearMemoryError(
 				"LinearMemoryConfig validation error: minPageCount greater than "
 				"max");
 		}
+		if (bounds_check != BoundsCheck::EXPLICIT && MAX_PAGE_COUNT < page_count_max) {
+			throw LinearMemoryError(
+				"LinearMemoryConfig validation error: maxPageCount exceeds the 32-bit index space");
+		}
 	}
+
+	/// The most pages a memory indexed by 32-bit addresses can hold.
+	///
+	static constexpr std::size_t MAX_PAGE_COUNT = 0x10000;
 };
 
+class LinearMemoryPool;
+class MemoryImage;
+
 /// The contiguous memory subsystem.
 ///
 /// web assembly gives programs low level access to a contiguous region of memory.
 /// The LinearMemory class manages that giant blob of memory. Per the spec, LinearMemory can be
-/// grown, but does not shrink.
+/// grown by the program. The embedder may shrink, or reset it.
+///
+/// The whole memory is reserved up front, so the memory never moves as it grows. Pages are
+/// committed, made readable and writable, as the memory grows. Changing permissions is costly:
+/// every mprotect shoots down the TLBs of every thread in the process. When accesses are checked
+/// explicitly, pages past the end of the memory may be committed, so commits are amortized, and
+/// grow in chunks. Under the other strategies, the end of the memory must fault, and exactly the
+/// pages of the memory are committed.
 ///
 class LinearMemory {
 public:
+	/// The size of a memory page. Pages are a fixed 64KiB, independent of the system page size.
+	///
+	static constexpr std::size_t PAGE_SIZE = kibibytes(std::size_t(64));
+
+	/// The reservation of a memory with a guard region: the 32-bit index space, and a guard region
+	/// covering a 32-bit offset and the widest access.
+	///
+	static constexpr std::size_t GUARDED_RESERVATION = gibibytes(std::size_t(8)) + PAGE_SIZE;
+
+	/// The size of the address range reserved for a memory. A masked memory is followed by a page,
+	/// so an access straddling the end of the mask still faults.
+	///
+	static std::size_t reservation_size(const LinearMemoryConfig& config) noexcept {
+		std::size_t max_size = std::max<std::size_t>(config.page_count_max, 1) * PAGE_SIZE;
+		switch (config.bounds_check) {
+		case BoundsCheck::GUARD_REGION:
+			return GUARDED_RESERVATION;
+		case BoundsCheck::MASK:
+			return std::bit_ceil(max_size) + PAGE_SIZE;
+		case BoundsCheck::EXPLICIT:
+		default:
+			return max_size;
+		}
+	}
+
 	/// The size of a memory page.
-	static std::size_t page_size() { return Page::size(); }
+	static std::size_t page_size() { return PAGE_SIZE; }
 
 	/// Bring up the memory subsytem.
 	///
 	LinearMemory(const LinearMemoryConfig& config)
-		: address_(nullptr), page_count_(0), config_(config) {
+		: address_(nullptr)
+		, page_count_(0)
+		, committed_page_count_(0)
+		, image_page_count_(0)
+		, image_fd_(-1)
+		, image_fd_page_count_(0)
+		, reserved_size_(0)
+		, config_(config)
+		, pool_(nullptr)
+		, numa_bound_(false) {
 		config_.verify();
-		address_ = reserve(config.address, config.page_count_max);
+		reserved_size_ = reservation_size(config);
+		address_       = reserve(config.address, reserved_size_);
 		grow(config.page_count_min);
 	}
 
+	/// Bring up a memory in a slot taken from a pool, rather than a reservation of it's own. The
+	/// config must fit the pool's slots. Throws if the pool is exhausted.
+	///
+	inline LinearMemory(const LinearMemoryConfig& config, LinearMemoryPool& pool);
+
 	/// Bring up the memory subsystem with the default config.
 	///
 	LinearMemory() : LinearMemory(LinearMemoryConfig()) {}
 
-	~LinearMemory() { release(address_, max_size()); }
+	LinearMemory(const LinearMemory&) = delete;
+
+	/// Release the reservation, or return the slot to it's pool.
+	///
+	inline ~LinearMemory();
+
+	LinearMemory& operator=(const LinearMemory&) = delete;
 
 	/// The address.
 
@@ -64,59 +206,617 @@ public:
 	///
 	std::size_t size() const noexcept { return page_count_ * page_size(); }
 
-	/// The maximum size the memory can grow to.
+	/// The number of pages currently allocated.
+	///
+	std::size_t page_count() const noexcept { return page_count_; }
+
+	/// The number of pages readable and writable. At least the page count.
+	///
+	std::size_t committed_page_count() const noexcept { return committed_page_count_; }
+
+	/// The number of leading pages mapped from an image. See map_image.
+	///
+	std::size_t image_page_count() const noexcept { return image_page_count_; }
+
+	/// The maximum number of pages.
+	///
+	std::size_t max_page_count() const noexcept { return config_.page_count_max; }
+
+	/// The maximum size the memory can grow to, in bytes.
+	///
+	std::size_t max_size() const noexcept { return config_.page_count_max * page_size(); }
+
+	/// The size of the address range reserved for the memory, in bytes. With a guard region, this
+	/// is much larger than the maximum size.
+	///
+	std::size_t reserved_size() const noexcept { return reserved_size_; }
+
+	/// The mask applied to every address under BoundsCheck::MASK. Zero under other strategies.
+	///
+	std::uint64_t mask() const noexcept {
+		return bounds_check() == BoundsCheck::MASK ? reserved_size_ - PAGE_SIZE - 1 : 0;
+	}
+
+	BoundsCheck bounds_check() const noexcept { return config_.bounds_check; }
+
+	/// The number of bytes of the reservation actually backed by huge pages. See
+	/// Page::huge_resident_size.
+	///
+	std::size_t huge_resident_size() const {
+		return Page::huge_resident_size(address_, reserved_size_);
+	}
+
+	/// Place the memory's reservation on a NUMA node. Returns false if the policy can't be set. See
+	/// Page::bind.
+	///
+	bool bind(unsigned node, NumaPolicy policy) noexcept {
+		bool bound  = Page::bind(address_, reserved_size_, node, policy);
+		numa_bound_ = bound && policy != NumaPolicy::DEFAULT;
+		return bound;
+	}
+
+	/// The pool the memory's slot was taken from, or null.
 	///
-	std::size_t max_size() const noexcept { return config_.page_count_max; }
+	LinearMemoryPool* pool() const noexcept { return pool_; }
+
+	/// True if len bytes at a guest address are within the memory.
+	///
+	bool contains(std::uint64_t addr, std::uint64_t len) const noexcept {
+		return addr <= size() && len <= size() - addr;
+	}
+
+	/// A view of len bytes at a guest address, for a host function to use in place, rather than
+	/// copy. Throws if the bytes are out of bounds.
+	///
+	/// The memory never moves, so a view stays valid as the memory grows. A view is invalidated
+	/// when the memory shrinks or resets below it, or is destroyed. The guest may write through
+	/// the view's bytes whenever it runs.
+	///
+	std::span<Byte> bytes(std::uint32_t addr, std::uint32_t len) const {
+		if (!contains(addr, len)) {
+			throw LinearMemoryError("Memory view out of bounds");
+		}
+		return {address_ + addr, len};
+	}
+
+	/// A view of count Ts at a guest address, with the lifetime of a view of bytes. The address
+	/// must be aligned for T. Both the guest and the host are little endian, so values need no
+	/// swapping.
+	///
+	template <typename T>
+	std::span<T> view(std::uint32_t addr, std::uint32_t count = 1) const {
+		static_assert(std::is_trivially_copyable_v<T>);
+		static_assert(std::endian::native == std::endian::little);
+		if (addr % alignof(T) != 0) {
+			throw LinearMemoryError("Memory view misaligned");
+		}
+		if (!contains(addr, std::uint64_t(count) * sizeof(T))) {
+			throw LinearMemoryError("Memory view out of bounds");
+		}
+		return {reinterpret_cast<T*>(address_ + addr), count};
+	}
+
+	/// True if the address falls in the memory's reservation, including any guard region.
+	///
+	bool reserves(const void* address) const noexcept {
+		auto p = static_cast<const Byte*>(address);
+		return address_ <= p && p < address_ + reserved_size_;
+	}
+
+	/// Grow the memory by n pages. Returns false, and leaves the memory unchanged, if the memory
+	/// would exceed it's maximum, or the pages can't be committed.
+	///
+	bool try_grow(std::size_t n = 1) noexcept {
+		if (config_.page_count_max - page_count_ < n) {
+			return false;
+		}
+
+		std::size_t target = page_count_ + n;
+
+		if (committed_page_count_ < target) {
+			std::size_t commit = target;
+			if (bounds_check() == BoundsCheck::EXPLICIT) {
+				// Commit at least a chunk, and at least double, so n single page grows take
+				// O(log n) commits.
+				commit = std::max({target, committed_page_count_ + config_.commit_chunk,
+					2 * committed_page_count_});
+				commit = std::min(commit, config_.page_count_max);
+			}
+
+			try {
+				activate(committed_page_count_, commit - committed_page_count_);
+			} catch (const PageError&) {
+				return false;
+			}
+			committed_page_count_ = commit;
+		}
+
+		page_count_ = target;
+		return true;
+	}
 
 	/// Grow the memory by n pages.
 	///
 	void grow(std::size_t n = 1) {
-		// TODO: worry about overflow / underflow
-		if (config_.page_count_max - page_count_ < n) {
+		if (!try_grow(n)) {
 			throw LinearMemoryError("Failed to grow, not enough reserved pages.");
 		}
-		activate(address_ + (page_count_ * page_size()), n);
-		page_count_ += n;
 	}
 
-	/// Shrink the memory by n pages.
+	/// Shrink the memory by n pages. The pages are returned to the OS, and read as zero if the
+	/// memory grows back over them, even where they were mapped from an image. See reset.
 	///
 	void shrink(std::size_t n = 1) {
 		if (page_count_ < n) {
 			throw LinearMemoryError("Failed to shrink: not enough active pages.");
 		}
-		/// TODO: Deactivate region
+
+		std::size_t target = page_count_ - n;
+
+		if (target < image_page_count_) {
+			drop_image(target);
+		}
+
+		// An explicitly checked memory keeps it's pages committed, only their contents are
+		// discarded. Otherwise, the pages must fault again.
+
+		if (bounds_check() == BoundsCheck::EXPLICIT) {
+			discard(target, committed_page_count_ - target);
+		} else {
+			deactivate(target, committed_page_count_ - target);
+			committed_page_count_ = target;
+		}
+
+		page_count_ = target;
+	}
+
+	/// Return the memory to it's initial state: the minimum size, and every byte zero, or the
+	/// size and contents of it's image. A memory shrunk below that size grows back, and image
+	/// pages dropped by a shrink are mapped again. Only pages written since they were last
+	/// discarded are restored, clean pages stay mapped.
+	///
+	void reset() {
+		std::size_t initial = std::max(config_.page_count_min, image_fd_page_count_);
+		if (initial < page_count_) {
+			shrink(page_count_ - initial);
+		} else if (page_count_ < initial) {
+			grow(initial - page_count_);
+		}
+		if (image_page_count_ < image_fd_page_count_) {
+			remap_image(image_page_count_);
+		}
+		discard_written(0, page_count_);
 	}
 
+	/// Replace the contents of a fresh memory with an image, mapped copy-on-write. Pages are
+	/// shared with every other memory mapping the image, until written. Discarding an image page
+	/// restores it's contents from the image.
+	///
+	inline void map_image(const MemoryImage& image);
+
 	const LinearMemoryConfig& config() const noexcept { return config_; }
 
 private:
-	MutAddress reserve(const MutAddress address, std::size_t n) {
-		return Page::map(address, n * page_size());
+	MutAddress reserve(const MutAddress address, std::size_t size) {
+		if (config_.huge_pages == HugePages::NONE) {
+			return Page::map(address, size);
+		}
+		MutAddress reservation = Page::map_aligned(size, Page::huge_size());
+		Page::advise_huge(reservation, size);
+		return reservation;
+	}
+
+	/// Restore the huge page advice on pages that have been mapped over.
+	///
+	void readvise(const std::size_t index, const std::size_t n) {
+		if (config_.huge_pages != HugePages::NONE) {
+			Page::advise_huge(page_address(index), n * page_size());
+		}
 	}
 
-	void activate(const MutAddress address, const std::size_t n) {
+	MutAddress page_address(std::size_t index) const noexcept {
+		return address_ + (index * page_size());
+	}
+
+	void activate(const std::size_t index, const std::size_t n) {
+		if (n == 0) {
+			return;
+		}
 		// activate the memory region by requesting read/write permissions.
 		auto permissions = PagePermission::READ | PagePermission::WRITE;
-		Page::set_permissions(address, n * Page::size(), permissions);
+		if (config_.prefault) {
+			Page::populate(page_address(index), n * page_size(), permissions);
+			readvise(index, n);
+		} else {
+			Page::set_permissions(page_address(index), n * page_size(), permissions);
+		}
 	}
 
-	void deactivate(const MutAddress address, const std::size_t n) {
-		// deactivate the memory region by disabling all permissions. this should hopefully
-		// cause the OS to unmap the memory.
-		auto permissions = PagePermission::NONE;
-		Page::set_permissions(address, n * Page::size(), permissions);
+	void deactivate(const std::size_t index, const std::size_t n) {
+		// deactivate the memory region by disabling all permissions, and return the pages to
+		// the OS.
+		if (n == 0) {
+			return;
+		}
+		discard(index, n);
+		Page::set_permissions(page_address(index), n * page_size(), PagePermission::NONE);
 	}
 
-	void release(const MutAddress address, const std::size_t n) {
-		Page::unmap(address, n * Page::size());
+	/// Unmap the image from page `index` on, leaving zeroed pages with the same permissions.
+	///
+	void drop_image(const std::size_t index) {
+		auto permissions = PagePermission::READ | PagePermission::WRITE;
+		Page::replace(page_address(index), (image_page_count_ - index) * page_size(), permissions);
+		readvise(index, image_page_count_ - index);
+		image_page_count_ = index;
 	}
 
+	/// Map the image again from page `index` on, over pages it was dropped from. The pages must be
+	/// committed.
+	///
+	void remap_image(const std::size_t index) {
+		auto permissions = PagePermission::READ | PagePermission::WRITE;
+		Page::map_file(page_address(index), (image_fd_page_count_ - index) * page_size(),
+			permissions, image_fd_, off_t(index * page_size()));
+		image_page_count_ = image_fd_page_count_;
+	}
+
+	/// Discard the pages in a range that have been written. See Page::for_each_written. If the
+	/// written pages can't be found, the whole range is discarded.
+	///
+	void discard_written(const std::size_t index, const std::size_t n) {
+		if (n == 0) {
+			return;
+		}
+		auto discard_run = [](MutAddress address, std::size_t size) {
+			Page::advise(address, size, PageAdvice::DONT_NEED);
+		};
+		if (!Page::for_each_written(page_address(index), n * page_size(), discard_run)) {
+			discard(index, n);
+		}
+	}
+
+	void discard(const std::size_t index, const std::size_t n) {
+		if (n == 0) {
+			return;
+		}
+		Page::advise(page_address(index), n * page_size(), PageAdvice::DONT_NEED);
+	}
+
+	void release(const MutAddress address, const std::size_t size) { Page::unmap(address, size); }
+
 	MutAddress address_;
 	std::size_t page_count_;
-	const LinearMemoryConfig config_;
+	std::size_t committed_page_count_;
+	std::size_t image_page_count_;
+	int image_fd_;                     ///< The image's file, kept to map again on reset, or -1.
+	std::size_t image_fd_page_count_;  ///< The size of the image, in pages.
+	std::size_t reserved_size_;
+	LinearMemoryConfig config_;
+	LinearMemoryPool* pool_;
+	bool numa_bound_;
+};
+
+/// A guest's iovec, as laid out in linear memory: the address and length of a buffer.
+///
+struct GuestIoVec {
+	std::uint32_t buf;
+	std::uint32_t len;
+};
+
+/// Host iovecs pointing straight into a linear memory, to pass guest buffers to readv, writev,
+/// sendmsg and the like without copying them. Every buffer is checked against the memory as it is
+/// appended, and the iovecs are views, with the lifetime of LinearMemory::bytes. A builder keeps
+/// it's storage when cleared, so one builder can serve every call of a host function.
+///
+class IoVecBuilder {
+public:
+	/// Append a buffer.
+	///
+	void append(std::span<Byte> bytes) {
+		iovecs_.push_back(iovec{bytes.data(), bytes.size()});
+		size_ += bytes.size();
+	}
+
+	/// Append the buffers of an array of count guest iovecs at a guest address. The array is read
+	/// once, so the guest changing it afterwards doesn't affect the host iovecs. Throws if the
+	/// array or any of it's buffers are out of bounds.
+	///
+	void append(const LinearMemory& memory, std::uint32_t addr, std::uint32_t count) {
+		iovecs_.reserve(iovecs_.size() + count);
+		for (const GuestIoVec& guest : memory.view<const GuestIoVec>(addr, count)) {
+			append(memory.bytes(guest.buf, guest.len));
+		}
+	}
+
+	void clear() noexcept {
+		iovecs_.clear();
+		size_ = 0;
+	}
+
+	const iovec* data() const noexcept { return iovecs_.data(); }
+
+	/// The number of iovecs.
+	///
+	std::size_t count() const noexcept { return iovecs_.size(); }
+
+	/// The total size of every buffer, in bytes.
+	///
+	std::size_t size() const noexcept { return size_; }
+
+	std::span<const iovec> iovecs() const noexcept { return iovecs_; }
+
+private:
+	std::vector<iovec> iovecs_;
+	std::size_t size_ = 0;
+};
+
+/// A snapshot of the contents of a linear memory, held in an anonymous, sealed memfd. Any number
+/// of memories may map the image. See LinearMemory::map_image.
+///
+class MemoryImage {
+public:
+	/// Copy the contents of a memory into a new image. The memory must not be written meanwhile.
+	///
+	explicit MemoryImage(const LinearMemory& memory)
+		: fd_(-1), page_count_(memory.page_count()) {
+		fd_ = memfd_create("ab-memory-image", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+		if (fd_ < 0) {
+			throw LinearMemoryError("Failed to create memory image");
+		}
+
+		try {
+			if (ftruncate(fd_, off_t(size())) != 0) {
+				throw LinearMemoryError("Failed to size memory image");
+			}
+
+			const Byte* data = memory.address();
+			std::size_t done = 0;
+			while (done < size()) {
+				ssize_t n = pwrite(fd_, data + done, size() - done, off_t(done));
+				if (n <= 0) {
+					throw LinearMemoryError("Failed to write memory image");
+				}
+				done += std::size_t(n);
+			}
+
+			int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+			if (fcntl(fd_, F_ADD_SEALS, seals) != 0) {
+				throw LinearMemoryError("Failed to seal memory image");
+			}
+		} catch (...) {
+			close(fd_);
+			throw;
+		}
+	}
+
+	MemoryImage(const MemoryImage&) = delete;
+
+	~MemoryImage() { close(fd_); }
+
+	MemoryImage& operator=(const MemoryImage&) = delete;
+
+	int fd() const noexcept { return fd_; }
+
+	/// The number of pages in the image.
+	///
+	std::size_t page_count() const noexcept { return page_count_; }
+
+	/// The size of the image, in bytes.
+	///
+	std::size_t size() const noexcept { return page_count_ * LinearMemory::PAGE_SIZE; }
+
+private:
+	int fd_;
+	std::size_t page_count_;
+};
+
+inline void LinearMemory::map_image(const MemoryImage& image) {
+	if (config_.page_count_max < image.page_count()) {
+		throw LinearMemoryError("Memory image exceeds the maximum size");
+	}
+	if (image_fd_ >= 0) {
+		throw LinearMemoryError("Memory already has an image");
+	}
+	if (image.page_count() == 0) {
+		return;
+	}
+
+	// The image may be destroyed before the memory, so hold on to it's file.
+	image_fd_ = dup(image.fd());
+	if (image_fd_ < 0) {
+		throw LinearMemoryError("Failed to keep memory image");
+	}
+	image_fd_page_count_ = image.page_count();
+
+	auto permissions = PagePermission::READ | PagePermission::WRITE;
+	Page::map_file(address_, image.size(), permissions, image.fd());
+
+	image_page_count_     = image.page_count();
+	page_count_           = std::max(page_count_, image_page_count_);
+	committed_page_count_ = std::max(committed_page_count_, image_page_count_);
+}
+
+struct LinearMemoryPoolConfig {
+	/// The number of slots.
+	///
+	std::size_t slot_count = 16;
+
+	/// The largest memory a slot can hold, in pages.
+	///
+	std::size_t page_count_max = LinearMemoryConfig::MAX_PAGE_COUNT;
+
+	/// The bounds check of every memory in the pool, which sizes the slots.
+	///
+	BoundsCheck bounds_check = DEFAULT_BOUNDS_CHECK;
+
+	/// Back every memory in the pool with huge pages. Slots are aligned to, and a whole number of,
+	/// huge pages. See LinearMemoryConfig::huge_pages.
+	///
+	HugePages huge_pages = HugePages::NONE;
 };
 
+/// A pool of linear memory slots, reserved together up front.
+///
+/// Creating a LinearMemory maps it's reservation, and destroying it unmaps it. Each takes the
+/// process-wide mmap lock, and instantiating many short lived modules contends on it. A pool makes
+/// a single reservation, carved into fixed size slots, each with room for any guard region. Slots
+/// are taken and returned in constant time, and never unmapped until the pool is destroyed.
+///
+/// A returned slot has it's pages discarded, so the next memory in the slot starts zeroed. The
+/// pages of an explicitly checked memory stay committed, so reusing the slot changes no page
+/// permissions.
+///
+class LinearMemoryPool {
+public:
+	explicit LinearMemoryPool(const LinearMemoryPoolConfig& config)
+		: config_(config), address_(nullptr), slot_size_(0) {
+		LinearMemoryConfig slot;
+		slot.page_count_min = 0;
+		slot.page_count_max = config.page_count_max;
+		slot.bounds_check   = config.bounds_check;
+		slot.verify();
+
+		slot_size_ = LinearMemory::reservation_size(slot);
+		if (config.huge_pages == HugePages::NONE) {
+			address_ = Page::map(slot_size_ * config.slot_count);
+		} else {
+			slot_size_ = Page::round_to_huge(slot_size_);
+			address_   = Page::map_aligned(slot_size_ * config.slot_count, Page::huge_size());
+			Page::advise_huge(address_, slot_size_ * config.slot_count);
+		}
+
+		free_.reserve(config.slot_count);
+		for (std::size_t i = config.slot_count; i > 0; --i) {
+			free_.push_back({address_ + ((i - 1) * slot_size_), 0});
+		}
+	}
+
+	LinearMemoryPool(const LinearMemoryPool&) = delete;
+
+	~LinearMemoryPool() { Page::unmap(address_, slot_size_ * config_.slot_count); }
+
+	LinearMemoryPool& operator=(const LinearMemoryPool&) = delete;
+
+	const LinearMemoryPoolConfig& config() const noexcept { return config_; }
+
+	BoundsCheck bounds_check() const noexcept { return config_.bounds_check; }
+
+	HugePages huge_pages() const noexcept { return config_.huge_pages; }
+
+	/// The size of the address range reserved for each slot.
+	///
+	std::size_t slot_size() const noexcept { return slot_size_; }
+
+	std::size_t slot_count() const noexcept { return config_.slot_count; }
+
+	/// The number of slots not in use.
+	///
+	std::size_t available() const {
+		std::lock_guard lock(mutex_);
+		return free_.size();
+	}
+
+	/// True if a memory with this config can be placed in a slot.
+	///
+	bool fits(const LinearMemoryConfig& config) const noexcept {
+		return config.bounds_check == config_.bounds_check &&
+		       config.page_count_max <= config_.page_count_max;
+	}
+
+	/// A free slot, and the number of pages left committed in it. The address is null if every
+	/// slot is in use.
+	///
+	struct Slot {
+		MutAddress address;
+		std::size_t committed_page_count;
+	};
+
+	Slot acquire() noexcept {
+		std::lock_guard lock(mutex_);
+		if (free_.empty()) {
+			return {nullptr, 0};
+		}
+		Slot slot = free_.back();
+		free_.pop_back();
+		return slot;
+	}
+
+	/// Return a slot to the pool. It's committed pages must already be discarded.
+	///
+	void release(Slot slot) noexcept {
+		std::lock_guard lock(mutex_);
+		free_.push_back(slot);
+	}
+
+private:
+	const LinearMemoryPoolConfig config_;
+	MutAddress address_;
+	std::size_t slot_size_;
+	mutable std::mutex mutex_;
+	std::vector<Slot> free_;
+};
+
+inline LinearMemory::LinearMemory(const LinearMemoryConfig& config, LinearMemoryPool& pool)
+	: address_(nullptr)
+	, page_count_(0)
+	, committed_page_count_(0)
+	, image_page_count_(0)
+	, image_fd_(-1)
+	, image_fd_page_count_(0)
+	, reserved_size_(pool.slot_size())
+	, config_(config)
+	, pool_(&pool)
+	, numa_bound_(false) {
+	config_.verify();
+	if (!pool.fits(config)) {
+		throw LinearMemoryError("Memory does not fit the pool's slots");
+	}
+	config_.huge_pages = pool.huge_pages();
+
+	LinearMemoryPool::Slot slot = pool.acquire();
+	if (slot.address == nullptr) {
+		throw LinearMemoryError("Memory pool exhausted");
+	}
+
+	address_              = slot.address;
+	committed_page_count_ = slot.committed_page_count;
+
+	if (!try_grow(config.page_count_min)) {
+		pool.release({address_, committed_page_count_});
+		throw LinearMemoryError("Failed to grow, not enough reserved pages.");
+	}
+}
+
+inline LinearMemory::~LinearMemory() {
+	if (image_fd_ >= 0) {
+		close(image_fd_);
+	}
+
+	if (pool_ == nullptr) {
+		release(address_, reserved_size_);
+		return;
+	}
+
+	// Empty the slot for the next memory. See LinearMemoryPool.
+
+	if (image_page_count_ != 0) {
+		drop_image(0);
+	}
+
+	if (numa_bound_) {
+		bind(0, NumaPolicy::DEFAULT);
+	}
+
+	if (bounds_check() == BoundsCheck::EXPLICIT) {
+		discard_written(0, committed_page_count_);
+	} else {
+		deactivate(0, committed_page_count_);
+		committed_page_count_ = 0;
+	}
+	pool_->release({address_, committed_page_count_});
+}
+
 }  // namespace Ab
 
 #endif  // AB_LINEARMEMORY_HPP_
@@ -28,18 +28,48 @@ inline std::shared_ptr<Module> compile(Context& cx, std::span<Byte> bytes) {
 	return compile(cx, ModuleStorage(bytes));
 }
 
+/// Place a new instance's memory on the context's NUMA node. See ContextConfig::numa_policy.
+///
+inline ModuleInst* place(Context& cx, ModuleInst* inst) noexcept {
+	cx.place(*inst);
+	return inst;
+}
+
 /// Instantiate a compiled module.
 ///
-/// The instantiation is owned by the VM.
-/// When the VM is destroyed, the module instance will be destroyed.
+/// The instantiation is owned by the caller, who may hand it to the VM, see
+/// VirtualMachine::add_module. Instantiation is safe from many threads at once.
+/// The module's code is threaded for the given dispatch strategy, and the bounds check of it's
+/// linear memory. If the VM has a memory pool, the memory is taken from the pool, under the
+/// pool's bounds check. The memory is placed on the context's NUMA node.
 /// @returns a pointer to the newly instantiated module instance
 ///
-inline ModuleInst* instantiate(Context& cx, const std::shared_ptr<Module>& module) {
-	return new ModuleInst(module);
+inline ModuleInst* instantiate(
+	Context& cx, const std::shared_ptr<Module>& module, Dispatch dispatch = DEFAULT_DISPATCH) {
+	if (LinearMemoryPool* pool = cx.vm()->memory_pool()) {
+		return place(cx, new ModuleInst(module, dispatch, *pool));
+	}
+	return place(cx, new ModuleInst(module, dispatch));
+}
+
+/// Instantiate a compiled module, with a memory of it's own under the given bounds check.
+///
+inline ModuleInst* instantiate(Context& cx, const std::shared_ptr<Module>& module,
+	Dispatch dispatch, BoundsCheck bounds_check) {
+	return place(cx, new ModuleInst(module, dispatch, bounds_check));
 }
 
-inline ModuleInst* instantiate(Context& cx, std::shared_ptr<Module>&& module) {
-	return new ModuleInst(std::move(module));
+/// Instantiate a snapshot of an instance. See ModuleInst::snapshot.
+///
+/// The new instance starts with the snapshot's globals, and maps the snapshot's memory image
+/// copy-on-write. If the VM has a memory pool, the memory is taken from the pool.
+///
+inline ModuleInst* instantiate(
+	Context& cx, const InstanceSnapshot& snapshot, Dispatch dispatch = DEFAULT_DISPATCH) {
+	if (LinearMemoryPool* pool = cx.vm()->memory_pool()) {
+		return place(cx, new ModuleInst(snapshot, dispatch, *pool));
+	}
+	return place(cx, new ModuleInst(snapshot, dispatch));
 }
 
 /// Instantiate a byte buffer.
@@ -49,8 +79,14 @@ inline ModuleInst* instantiate(Context& cx, std::shared_ptr<Module>&& module) {
 /// When the Module is destroyed, the bytes will be released via std::free.
 /// The Module will be destroyed when there are no more instances.
 ///
-inline ModuleInst* instantiate(Context& cx, std::span<Byte> bytes) {
-	return instantiate(cx, compile(cx, bytes));
+inline ModuleInst*
+instantiate(Context& cx, std::span<Byte> bytes, Dispatch dispatch = DEFAULT_DISPATCH) {
+	return instantiate(cx, compile(cx, bytes), dispatch);
+}
+
+inline ModuleInst*
+instantiate(Context& cx, std::span<Byte> bytes, Dispatch dispatch, BoundsCheck bounds_check) {
+	return instantiate(cx, compile(cx, bytes), dispatch, bounds_check);
 }
 
 ModuleInst* instantiate_file(Context& cx, const std::string& filename);
@@ -6,9 +6,13 @@
 #include <Ab/Address.hpp>
 #include <Ab/Assert.hpp>
 #include <Ab/Bytes.hpp>
+#include <Ab/Dispatch.hpp>
 #include <Ab/Func.hpp>
+#include <Ab/LinearMemory.hpp>
+#include <Ab/Threading.hpp>
 #include <Ab/VectorUtilities.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <span>
@@ -101,6 +105,35 @@ public:
 
 	const std::vector<FuncType>& type_table() const noexcept { return type_table_; }
 
+	/// The module's linear memories. A module has at most one.
+	///
+	std::vector<MemoryType>& memory_table() noexcept { return memory_table_; }
+
+	const std::vector<MemoryType>& memory_table() const noexcept { return memory_table_; }
+
+	std::vector<GlobalEntry>& global_table() noexcept { return global_table_; }
+
+	const std::vector<GlobalEntry>& global_table() const noexcept { return global_table_; }
+
+	/// The module's f32 constants. Referenced by index from `_rc` instructions.
+	///
+	std::vector<float>& f32_table() noexcept { return f32_table_; }
+
+	const std::vector<float>& f32_table() const noexcept { return f32_table_; }
+
+	/// The module's f64 constants. Referenced by index from `_rc` instructions.
+	///
+	std::vector<double>& f64_table() noexcept { return f64_table_; }
+
+	const std::vector<double>& f64_table() const noexcept { return f64_table_; }
+
+	/// The module's data segments. Each is a view of the module's bytes, copied into linear memory
+	/// by `memory.init`.
+	///
+	std::vector<std::span<const Byte>>& data_table() noexcept { return data_table_; }
+
+	const std::vector<std::span<const Byte>>& data_table() const noexcept { return data_table_; }
+
 	std::vector<std::uint32_t>& func_types() noexcept { return func_types_; }
 
 	const std::vector<std::uint32_t>& func_types() const noexcept { return func_types_; }
@@ -116,17 +149,68 @@ private:
 	ModuleStorage storage_;
 	FuncTable func_table_;
 	std::vector<FuncType> type_table_;
+	std::vector<MemoryType> memory_table_;
+	std::vector<GlobalEntry> global_table_;
+	std::vector<float> f32_table_;
+	std::vector<double> f64_table_;
+	std::vector<std::span<const Byte>> data_table_;
 	std::vector<std::uint32_t> func_types_;
 };
 
+/// A frozen copy of an initialized instance: the values of it's globals, the state of it's data
+/// segments, and an image of it's linear memory. Instances made from a snapshot start in the
+/// snapshot's state, sharing the memory image copy-on-write. See ModuleInst::snapshot.
+///
+struct InstanceSnapshot {
+	std::shared_ptr<Module> module;
+	std::vector<std::uint64_t> globals;
+	std::vector<std::span<const Byte>> data;
+	std::shared_ptr<const MemoryImage> memory_image;
+};
+
 /// Module Instance.
 /// An instantiated module, the runtime-side of a module.
 ///
 class ModuleInst {
 public:
-	ModuleInst(const std::shared_ptr<Module>& module) : module_(module) { initialize(); }
+	ModuleInst(const std::shared_ptr<Module>& module, Dispatch dispatch = DEFAULT_DISPATCH,
+		BoundsCheck bounds_check = DEFAULT_BOUNDS_CHECK)
+		: module_(module), dispatch_(dispatch) {
+		initialize(bounds_check, nullptr);
+	}
+
+	ModuleInst(std::shared_ptr<Module>&& module, Dispatch dispatch = DEFAULT_DISPATCH,
+		BoundsCheck bounds_check = DEFAULT_BOUNDS_CHECK)
+		: module_(std::move(module)), dispatch_(dispatch) {
+		initialize(bounds_check, nullptr);
+	}
+
+	/// Instantiate with a memory taken from a pool, under the pool's bounds check. A memory too
+	/// large for the pool's slots gets a reservation of it's own.
+	///
+	ModuleInst(const std::shared_ptr<Module>& module, Dispatch dispatch, LinearMemoryPool& pool)
+		: module_(module), dispatch_(dispatch) {
+		initialize(pool.bounds_check(), &pool);
+	}
+
+	/// Instantiate from a snapshot. The instance starts with the snapshot's globals and memory.
+	///
+	ModuleInst(const InstanceSnapshot& snapshot, Dispatch dispatch = DEFAULT_DISPATCH,
+		BoundsCheck bounds_check = DEFAULT_BOUNDS_CHECK)
+		: module_(snapshot.module), dispatch_(dispatch) {
+		initialize(bounds_check, nullptr);
+		restore(snapshot);
+	}
+
+	/// Instantiate from a snapshot, with a memory taken from a pool.
+	///
+	ModuleInst(const InstanceSnapshot& snapshot, Dispatch dispatch, LinearMemoryPool& pool)
+		: module_(snapshot.module), dispatch_(dispatch) {
+		initialize(pool.bounds_check(), &pool);
+		restore(snapshot);
+	}
 
-	ModuleInst(std::shared_ptr<Module>&& module) : module_(std::move(module)) { initialize(); }
+	ModuleInst(const ModuleInst&) = delete;
 
 	/// Obtain the underlying, stateless representation of the module.
 	/// Note that the module may be shared by multiple instantiations.
@@ -137,6 +221,10 @@ public:
 	///
 	std::span<Byte> bytes() const noexcept { return module_->bytes(); }
 
+	/// The dispatch strategy the module's code was threaded for.
+	///
+	Dispatch dispatch() const noexcept { return dispatch_; }
+
 	std::vector<FuncInst>& func_inst_table() noexcept { return func_inst_table_; }
 
 	const std::vector<FuncInst>& func_inst_table() const noexcept { return func_inst_table_; }
@@ -155,6 +243,55 @@ public:
 		return &func_inst_table_[index];
 	}
 
+	/// The slot holding the value of a global.
+	///
+	std::uint64_t* global(std::size_t index) noexcept {
+		AB_ASSERT(index < module_->global_table().size());
+		return &globals_[index];
+	}
+
+	/// The threaded code of every function in the module.
+	///
+	const ThreadedCode& threaded_code() const noexcept { return threaded_code_; }
+
+	/// The instance's linear memory, or null if the module has none.
+	///
+	LinearMemory* memory() noexcept { return memory_.get(); }
+
+	const LinearMemory* memory() const noexcept { return memory_.get(); }
+
+	/// Return the instance to the state it was instantiated in: every global to it's initial value,
+	/// every dropped data segment back, and the memory to it's initial size and contents. Only the
+	/// memory pages written since the last reset are restored, so a reset costs as much as the
+	/// instance's writes, rather than the size of it's memory. See LinearMemory::reset.
+	///
+	void reset() {
+		std::copy(initial_globals_.begin(), initial_globals_.end(), globals_.get());
+		for (std::size_t i = 0; i < data_segments_.size(); ++i) {
+			data_segments_[i].bytes = initial_data_[i];
+		}
+		if (memory_) {
+			memory_->reset();
+		}
+	}
+
+	/// Freeze the current state of the instance. The memory is copied into an image once, and
+	/// every instance made from the snapshot maps that image copy-on-write, so instantiation costs
+	/// no more than mapping, however large the memory. Tables are immutable, and are not captured.
+	///
+	std::shared_ptr<const InstanceSnapshot> snapshot() const {
+		auto snapshot    = std::make_shared<InstanceSnapshot>();
+		snapshot->module = module_;
+		snapshot->globals.assign(globals_.get(), globals_.get() + module_->global_table().size());
+		for (const DataSegment& segment : data_segments_) {
+			snapshot->data.push_back(segment.bytes);
+		}
+		if (memory_) {
+			snapshot->memory_image = std::make_shared<const MemoryImage>(*memory_);
+		}
+		return snapshot;
+	}
+
 #if 0  /////////////////////////////////////////////////////////////////////////
 
 	/// Find an function by name.
@@ -193,10 +330,148 @@ public:
 	std::vector<FuncInst> func_inst_table_;
 
 private:
-	void initialize() {
+	Dispatch dispatch_;
+
+	/// The threaded code of every function in the module. See Threading.hpp.
+	///
+	ThreadedCode threaded_code_;
+
+	/// The value of every global in the module, one 64-bit slot each.
+	///
+	std::unique_ptr<std::uint64_t[]> globals_;
+
+	/// The value of every global on instantiation. See reset.
+	///
+	std::vector<std::uint64_t> initial_globals_;
+
+	/// The instance's data segments. Referenced from the constant pool, so never reallocated.
+	///
+	std::vector<DataSegment> data_segments_;
+
+	/// The data segments on instantiation. See reset.
+	///
+	std::vector<std::span<const Byte>> initial_data_;
+
+	/// The instance's linear memory. The load and store handlers are specialized for it's bounds
+	/// check when the code is threaded.
+	///
+	std::unique_ptr<LinearMemory> memory_;
+
+	/// The constants of every function in the instance. Each FuncInst points here, so the
+	/// instance never moves.
+	///
+	ConstPool const_pool_;
+
+	void restore(const InstanceSnapshot& snapshot) {
+		AB_ASSERT(snapshot.globals.size() == module_->global_table().size());
+		std::copy(snapshot.globals.begin(), snapshot.globals.end(), globals_.get());
+		initial_globals_ = snapshot.globals;
+		AB_ASSERT(snapshot.data.size() == data_segments_.size());
+		for (std::size_t i = 0; i < data_segments_.size(); ++i) {
+			data_segments_[i].bytes = snapshot.data[i];
+		}
+		initial_data_ = snapshot.data;
+		if (snapshot.memory_image) {
+			AB_ASSERT(memory_ != nullptr);
+			memory_->map_image(*snapshot.memory_image);
+		}
+	}
+
+	void initialize(BoundsCheck bounds_check, LinearMemoryPool* pool) {
+		// Bring up the linear memory.
+
+		for (const MemoryType& type : module_->memory_table()) {
+			LinearMemoryConfig config;
+			config.page_count_min = type.min;
+			config.page_count_max = type.max;
+			config.bounds_check   = bounds_check;
+			if (pool != nullptr && pool->fits(config)) {
+				memory_ = std::make_unique<LinearMemory>(config, *pool);
+			} else {
+				memory_ = std::make_unique<LinearMemory>(config);
+			}
+		}
+
+		// Thread every function body into a single buffer, owned by the instance.
+
+		std::vector<std::size_t> offsets;
+		std::size_t size = 0;
+
+		offsets.reserve(module_->func_table().size());
+		for (auto& func : module_->func_table()) {
+			offsets.push_back(size);
+			size += threaded_size(func.body_bytes());
+		}
+
+		threaded_code_ = ThreadedCode(size);
+
+		// Every data segment starts as a view of the module's bytes.
+
+		initial_data_ = module_->data_table();
+		data_segments_.reserve(initial_data_.size());
+		for (std::span<const Byte> bytes : initial_data_) {
+			data_segments_.push_back(DataSegment{bytes});
+		}
+
+		// Initialize the globals.
+
+		const auto& global_table = module_->global_table();
+
+		globals_ = std::make_unique<std::uint64_t[]>(global_table.size());
+		initial_globals_.reserve(global_table.size());
+		for (std::size_t i = 0; i < global_table.size(); ++i) {
+			globals_[i] = global_table[i].init;
+			initial_globals_.push_back(global_table[i].init);
+		}
+
+		// The constant pool is owned by the instance, shared by every function, and fully resolved
+		// before any code is threaded: the threader checks constant indices against it, and
+		// quickens every instruction with a resolvable index. Threaded code is never rewritten
+		// afterwards, so an instance may run on many threads at once. Memory accesses are threaded
+		// for the bounds check of the memory. The func table must not reallocate past this point.
+
 		func_inst_table_.reserve(module_->func_table().size());
+
+		ConstPool& consts = const_pool_;
+		consts.f32_table = module_->f32_table();
+		consts.f64_table = module_->f64_table();
+
+		consts.func_table.reserve(module_->func_table().size());
+		for (std::size_t i = 0; i < module_->func_table().size(); ++i) {
+			consts.func_table.push_back(func_inst_table_.data() + i);
+		}
+
+		consts.type_table.reserve(module_->type_table().size());
+		for (const auto& type : module_->type_table()) {
+			consts.type_table.push_back(&type);
+		}
+
+		consts.global_table.reserve(global_table.size());
+		for (std::size_t i = 0; i < global_table.size(); ++i) {
+			consts.global_table.push_back(&globals_[i]);
+		}
+
+		consts.data_table.reserve(data_segments_.size());
+		for (DataSegment& segment : data_segments_) {
+			consts.data_table.push_back(&segment);
+		}
+
+		if (memory_) {
+			consts.memory      = memory_.get();
+			consts.memory_base = memory_->address();
+			consts.memory_mask = memory_->mask();
+		}
+
+		// Every func is instantiated before any is threaded, so a call can be checked against the
+		// arguments of it's callee.
+
 		for (auto& func : module_->func_table()) {
-			func_inst_table_.emplace_back(&func);
+			Byte* body = threaded_code_.get() + offsets[func_inst_table_.size()];
+			func_inst_table_.emplace_back(&func, body, dispatch_, &const_pool_);
+		}
+
+		for (FuncInst& inst : func_inst_table_) {
+			thread_body(inst.base()->body_bytes(), inst.nregs(), inst.body(), dispatch_, consts);
 		}
 	}
 };
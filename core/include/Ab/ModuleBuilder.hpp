@@ -31,9 +31,14 @@ enum class InsnKind {
 	HALT,
 	NOP,
 	I32_ADD,
+	I32_ADD_RI,
+	I64_ADD_RI,
+	F32_ADD_RC,
+	F64_ADD_RC,
 	RETURN,
 	X32_RETURN,
 	X64_RETURN,
+	BYTECODE,
 	LABEL,
 };
 
@@ -54,9 +59,14 @@ class UnreachableInsnNode;
 class NopInsnNode;
 class HaltInsnNode;
 class I32AddInsnNode;
+class I32AddRiInsnNode;
+class I64AddRiInsnNode;
+class F32AddRcInsnNode;
+class F64AddRcInsnNode;
 class ReturnInsnNode;
 class X32ReturnInsnNode;
 class X64ReturnInsnNode;
+class BytecodeInsnNode;
 
 class InsnVisitor {
 public:
@@ -70,11 +80,21 @@ public:
 
 	virtual void on_i32_add(I32AddInsnNode& n) = 0;
 
+	virtual void on_i32_add_ri(I32AddRiInsnNode& n) = 0;
+
+	virtual void on_i64_add_ri(I64AddRiInsnNode& n) = 0;
+
+	virtual void on_f32_add_rc(F32AddRcInsnNode& n) = 0;
+
+	virtual void on_f64_add_rc(F64AddRcInsnNode& n) = 0;
+
 	virtual void on_return(ReturnInsnNode& n) = 0;
 
 	virtual void on_x32_return(X32ReturnInsnNode& n) = 0;
 
 	virtual void on_x64_return(X64ReturnInsnNode& n) = 0;
+
+	virtual void on_bytecode(BytecodeInsnNode& n) = 0;
 };
 
 inline InsnVisitor::~InsnVisitor() noexcept = default;
@@ -124,6 +144,82 @@ public:
 	std::uint32_t rhs;
 };
 
+class I32AddRiInsnNode final : public InsnNode {
+public:
+	I32AddRiInsnNode() noexcept = default;
+
+	constexpr I32AddRiInsnNode(std::uint32_t dst, std::uint32_t lhs, std::int32_t rhs) noexcept
+		: dst(dst), lhs(lhs), rhs(rhs) {}
+
+	virtual ~I32AddRiInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I32_ADD_RI; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i32_add_ri(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t lhs;
+	std::int32_t rhs;
+};
+
+class I64AddRiInsnNode final : public InsnNode {
+public:
+	I64AddRiInsnNode() noexcept = default;
+
+	constexpr I64AddRiInsnNode(std::uint32_t dst, std::uint32_t lhs, std::int64_t rhs) noexcept
+		: dst(dst), lhs(lhs), rhs(rhs) {}
+
+	virtual ~I64AddRiInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::I64_ADD_RI; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_i64_add_ri(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t lhs;
+	std::int64_t rhs;
+};
+
+/// Add a constant from the module's f32 table. `rhs` is the index of the constant.
+///
+class F32AddRcInsnNode final : public InsnNode {
+public:
+	F32AddRcInsnNode() noexcept = default;
+
+	constexpr F32AddRcInsnNode(std::uint32_t dst, std::uint32_t lhs, std::uint32_t rhs) noexcept
+		: dst(dst), lhs(lhs), rhs(rhs) {}
+
+	virtual ~F32AddRcInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::F32_ADD_RC; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_f32_add_rc(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t lhs;
+	std::uint32_t rhs;
+};
+
+/// Add a constant from the module's f64 table. `rhs` is the index of the constant.
+///
+class F64AddRcInsnNode final : public InsnNode {
+public:
+	F64AddRcInsnNode() noexcept = default;
+
+	constexpr F64AddRcInsnNode(std::uint32_t dst, std::uint32_t lhs, std::uint32_t rhs) noexcept
+		: dst(dst), lhs(lhs), rhs(rhs) {}
+
+	virtual ~F64AddRcInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::F64_ADD_RC; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_f64_add_rc(*this); }
+
+	std::uint32_t dst;
+	std::uint32_t lhs;
+	std::uint32_t rhs;
+};
+
 class ReturnInsnNode final : public InsnNode {
 public:
 	constexpr ReturnInsnNode() noexcept = default;
@@ -161,6 +257,21 @@ public:
 	std::uint32_t src;
 };
 
+/// A sequence of raw, pre-encoded instructions. Typically the output of a FuncBuilder.
+///
+class BytecodeInsnNode final : public InsnNode {
+public:
+	BytecodeInsnNode(ByteBuffer&& bytes) noexcept : bytes(std::move(bytes)) {}
+
+	virtual ~BytecodeInsnNode() noexcept override = default;
+
+	virtual InsnKind kind() const noexcept override { return InsnKind::BYTECODE; }
+
+	virtual void accept(InsnVisitor& v) override { return v.on_bytecode(*this); }
+
+	ByteBuffer bytes;
+};
+
 #if 0  //////////////////////////////////////////////////////////////////////////
 
 struct CodeMetadata {
@@ -242,6 +353,26 @@ public:
 				visitor.on_i32_add(x.dst, x.lhs, x.rhs);
 				break;
 			}
+			case InsnKind::I32_ADD_RI: {
+				auto& x = static_cast<I32AddRiInsnNode&>(insn);
+				visitor.on_i32_add_ri(x.dst, x.lhs, x.rhs);
+				break;
+			}
+			case InsnKind::I64_ADD_RI: {
+				auto& x = static_cast<I64AddRiInsnNode&>(insn);
+				visitor.on_i64_add_ri(x.dst, x.lhs, x.rhs);
+				break;
+			}
+			case InsnKind::F32_ADD_RC: {
+				auto& x = static_cast<F32AddRcInsnNode&>(insn);
+				visitor.on_f32_add_rc(x.dst, x.lhs, x.rhs);
+				break;
+			}
+			case InsnKind::F64_ADD_RC: {
+				auto& x = static_cast<F64AddRcInsnNode&>(insn);
+				visitor.on_f64_add_rc(x.dst, x.lhs, x.rhs);
+				break;
+			}
 			case InsnKind::RETURN:
 				visitor.on_return();
 				break;
@@ -255,6 +386,11 @@ public:
 				visitor.on_x64_return(x.src);
 				break;
 			}
+			case InsnKind::BYTECODE: {
+				auto& x = static_cast<BytecodeInsnNode&>(insn);
+				visitor.on_bytecode({x.bytes.data(), x.bytes.size()});
+				break;
+			}
 			default:
 				AB_ASSERT_UNREACHABLE();
 				break;
@@ -288,7 +424,11 @@ public:
 		accept_type_section(visitor);
 		accept_export_section(visitor);
 		accept_func_section(visitor);
+		accept_memory_section(visitor);
+		accept_global_section(visitor);
+		accept_const_section(visitor);
 		accept_code_section(visitor);
+		accept_data_section(visitor);
 		visitor.leave_module();
 	}
 
@@ -303,6 +443,11 @@ public:
 
 	std::vector<FuncNode> funcs;
 	std::vector<FuncType> types;
+	std::vector<MemoryType> memories;
+	std::vector<GlobalEntry> globals;
+	std::vector<float> f32_consts;
+	std::vector<double> f64_consts;
+	std::vector<std::vector<Byte>> data;
 
 private:
 	void accept_type_section(ModuleVisitor& visitor) {
@@ -326,6 +471,33 @@ private:
 		visitor.leave_func_section();
 	}
 
+	void accept_memory_section(ModuleVisitor& visitor) {
+		visitor.enter_memory_section();
+		for (const auto& memory : memories) {
+			visitor.on_memory(memory);
+		}
+		visitor.leave_memory_section();
+	}
+
+	void accept_global_section(ModuleVisitor& visitor) {
+		visitor.enter_global_section();
+		for (const auto& global : globals) {
+			visitor.on_global(global);
+		}
+		visitor.leave_global_section();
+	}
+
+	void accept_const_section(ModuleVisitor& visitor) {
+		visitor.enter_const_section();
+		for (float value : f32_consts) {
+			visitor.on_f32_const(value);
+		}
+		for (double value : f64_consts) {
+			visitor.on_f64_const(value);
+		}
+		visitor.leave_const_section();
+	}
+
 	void accept_code_section(ModuleVisitor& visitor) {
 		visitor.enter_code_section();
 		for (auto& func : funcs) {
@@ -333,6 +505,14 @@ private:
 		}
 		visitor.leave_code_section();
 	}
+
+	void accept_data_section(ModuleVisitor& visitor) {
+		visitor.enter_data_section();
+		for (const auto& bytes : data) {
+			visitor.on_data(bytes);
+		}
+		visitor.leave_data_section();
+	}
 };
 
 #if 0   /////////////////////////////////////////////////////////////////////////
@@ -25,7 +25,8 @@ enum class SectionCode : std::uint8_t {
 	ELEMENT = 0x9,
 	CODE    = 0xa,
 	DATA    = 0xb,
-	LAST    = DATA
+	CONST   = 0xc,  // Ab: the f32 and f64 constant tables.
+	LAST    = CONST
 };
 
 enum class ValType : std::uint8_t {
@@ -1,8 +1,10 @@
 #ifndef AB_MODULEVISITATION_HPP_
 #define AB_MODULEVISITATION_HPP_
 
+#include <Ab/Bytes.hpp>
 #include <Ab/ModuleConstants.hpp>
 #include <Ab/Types.hpp>
+#include <span>
 #include <vector>
 
 namespace Ab {
@@ -19,6 +21,14 @@ public:
 
 	virtual void on_i32_add(std::uint8_t dst, std::uint8_t lhs, std::uint8_t rhs) = 0;
 
+	virtual void on_i32_add_ri(std::uint8_t dst, std::uint8_t lhs, std::int32_t rhs) = 0;
+
+	virtual void on_i64_add_ri(std::uint8_t dst, std::uint8_t lhs, std::int64_t rhs) = 0;
+
+	virtual void on_f32_add_rc(std::uint8_t dst, std::uint8_t lhs, std::uint32_t rhs) = 0;
+
+	virtual void on_f64_add_rc(std::uint8_t dst, std::uint8_t lhs, std::uint32_t rhs) = 0;
+
 	virtual void on_return() = 0;
 
 	virtual void on_x32_return(std::uint8_t ret) = 0;
@@ -38,6 +48,14 @@ public:
 
 	virtual void on_i32_add(std::uint8_t, std::uint8_t, std::uint8_t) override {}
 
+	virtual void on_i32_add_ri(std::uint8_t, std::uint8_t, std::int32_t) override {}
+
+	virtual void on_i64_add_ri(std::uint8_t, std::uint8_t, std::int64_t) override {}
+
+	virtual void on_f32_add_rc(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_f64_add_rc(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
 	virtual void on_return() override {}
 
 	virtual void on_x32_return(std::uint8_t) override {}
@@ -74,11 +92,23 @@ public:
 
 	virtual void on_i32_add(std::uint8_t dst, std::uint8_t lhs, std::uint8_t rhs) = 0;
 
+	virtual void on_i32_add_ri(std::uint8_t dst, std::uint8_t lhs, std::int32_t rhs) = 0;
+
+	virtual void on_i64_add_ri(std::uint8_t dst, std::uint8_t lhs, std::int64_t rhs) = 0;
+
+	virtual void on_f32_add_rc(std::uint8_t dst, std::uint8_t lhs, std::uint32_t rhs) = 0;
+
+	virtual void on_f64_add_rc(std::uint8_t dst, std::uint8_t lhs, std::uint32_t rhs) = 0;
+
 	virtual void on_return() = 0;
 
 	virtual void on_x32_return(std::uint8_t src) = 0;
 
 	virtual void on_x64_return(std::uint8_t src) = 0;
+
+	/// A run of pre-encoded instructions, eg. produced by a FuncBuilder.
+	///
+	virtual void on_bytecode(std::span<const Byte> bytes) = 0;
 };
 
 /// A function visitor that does nothing--useful as a base class.
@@ -103,11 +133,21 @@ public:
 
 	virtual void on_i32_add(std::uint8_t, std::uint8_t, std::uint8_t) override {}
 
+	virtual void on_i32_add_ri(std::uint8_t, std::uint8_t, std::int32_t) override {}
+
+	virtual void on_i64_add_ri(std::uint8_t, std::uint8_t, std::int64_t) override {}
+
+	virtual void on_f32_add_rc(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
+	virtual void on_f64_add_rc(std::uint8_t, std::uint8_t, std::uint32_t) override {}
+
 	virtual void on_return() override {}
 
 	virtual void on_x32_return(std::uint8_t) override {}
 
 	virtual void on_x64_return(std::uint8_t) override {}
+
+	virtual void on_bytecode(std::span<const Byte>) override {}
 };
 
 class CodeModel {
@@ -145,6 +185,32 @@ public:
 
 	virtual void on_func(std::uint32_t type_idx) = 0;
 
+	// Memory Section
+
+	virtual void enter_memory_section() = 0;
+
+	virtual void leave_memory_section() = 0;
+
+	virtual void on_memory(const MemoryType& memory) = 0;
+
+	// Global Section
+
+	virtual void enter_global_section() = 0;
+
+	virtual void leave_global_section() = 0;
+
+	virtual void on_global(const GlobalEntry& global) = 0;
+
+	// Const Section
+
+	virtual void enter_const_section() = 0;
+
+	virtual void leave_const_section() = 0;
+
+	virtual void on_f32_const(float value) = 0;
+
+	virtual void on_f64_const(double value) = 0;
+
 	// Export Section
 
 	virtual void enter_export_section() = 0;
@@ -158,6 +224,14 @@ public:
 	virtual void leave_code_section() = 0;
 
 	virtual void on_code(CodeModel& model) = 0;
+
+	// Data Section
+
+	virtual void enter_data_section() = 0;
+
+	virtual void leave_data_section() = 0;
+
+	virtual void on_data(std::span<const Byte> bytes) = 0;
 };
 
 /// Basic visitor that does nothing by default.
@@ -188,6 +262,32 @@ public:
 
 	virtual void on_func(std::uint32_t) override {}
 
+	// Memory Section
+
+	virtual void enter_memory_section() override {}
+
+	virtual void leave_memory_section() override {}
+
+	virtual void on_memory(const MemoryType&) override {}
+
+	// Global Section
+
+	virtual void enter_global_section() override {}
+
+	virtual void leave_global_section() override {}
+
+	virtual void on_global(const GlobalEntry&) override {}
+
+	// Const Section
+
+	virtual void enter_const_section() override {}
+
+	virtual void leave_const_section() override {}
+
+	virtual void on_f32_const(float) override {}
+
+	virtual void on_f64_const(double) override {}
+
 	// Export Section
 
 	virtual void enter_export_section() override {}
@@ -201,6 +301,14 @@ public:
 	virtual void leave_code_section() override {}
 
 	virtual void on_code(CodeModel&) override {}
+
+	// Data Section
+
+	virtual void enter_data_section() override {}
+
+	virtual void leave_data_section() override {}
+
+	virtual void on_data(std::span<const Byte>) override {}
 };
 
 class ModuleModel {
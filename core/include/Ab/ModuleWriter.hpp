@@ -53,6 +53,34 @@ public:
 		body_.append(rhs);
 	}
 
+	virtual void on_i32_add_ri(std::uint8_t dst, std::uint8_t lhs, std::int32_t rhs) override {
+		body_.append(Opcode::I32_ADD_RI);
+		body_.append(dst);
+		body_.append(lhs);
+		body_.append(rhs);
+	}
+
+	virtual void on_i64_add_ri(std::uint8_t dst, std::uint8_t lhs, std::int64_t rhs) override {
+		body_.append(Opcode::I64_ADD_RI);
+		body_.append(dst);
+		body_.append(lhs);
+		body_.append(rhs);
+	}
+
+	virtual void on_f32_add_rc(std::uint8_t dst, std::uint8_t lhs, std::uint32_t rhs) override {
+		body_.append(Opcode::F32_ADD_RC);
+		body_.append(dst);
+		body_.append(lhs);
+		body_.append(rhs);
+	}
+
+	virtual void on_f64_add_rc(std::uint8_t dst, std::uint8_t lhs, std::uint32_t rhs) override {
+		body_.append(Opcode::F64_ADD_RC);
+		body_.append(dst);
+		body_.append(lhs);
+		body_.append(rhs);
+	}
+
 	virtual void on_return() override { body_.append(Opcode::RETURN); }
 
 	virtual void on_x32_return(std::uint8_t src) override {
@@ -65,6 +93,10 @@ public:
 		body_.append(src);
 	}
 
+	virtual void on_bytecode(std::span<const Byte> bytes) override {
+		body_.append(bytes.data(), bytes.size());
+	}
+
 	void append_to(ByteBuffer& buffer) const {
 		ByteBuffer content;
 
@@ -116,6 +148,32 @@ public:
 
 	virtual void on_func(std::uint32_t type_idx) override { func_entries_.push_back(type_idx); }
 
+	// Memory Section
+
+	virtual void enter_memory_section() override {}
+
+	virtual void leave_memory_section() override {}
+
+	virtual void on_memory(const MemoryType& memory) override { memory_entries_.push_back(memory); }
+
+	// Global Section
+
+	virtual void enter_global_section() override {}
+
+	virtual void leave_global_section() override {}
+
+	virtual void on_global(const GlobalEntry& global) override { global_entries_.push_back(global); }
+
+	// Const Section
+
+	virtual void enter_const_section() override {}
+
+	virtual void leave_const_section() override {}
+
+	virtual void on_f32_const(float value) override { f32_entries_.push_back(value); }
+
+	virtual void on_f64_const(double value) override { f64_entries_.push_back(value); }
+
 	// Export Section
 
 	virtual void enter_export_section() override {}
@@ -130,13 +188,27 @@ public:
 
 	virtual void on_code(CodeModel& model) override { model.accept(push(code_entries_)); }
 
+	// Data Section
+
+	virtual void enter_data_section() override {}
+
+	virtual void leave_data_section() override {}
+
+	virtual void on_data(std::span<const Byte> bytes) override {
+		data_entries_.emplace_back(bytes.begin(), bytes.end());
+	}
+
 private:
 	void append_module(ByteBuffer& buffer) const {
 		buffer.append(MODULE_MAGIC);
 		buffer.append(MODULE_VERSION);
 		append_type_section(buffer);
 		append_func_section(buffer);
+		append_memory_section(buffer);
+		append_global_section(buffer);
+		append_const_section(buffer);
 		append_code_section(buffer);
+		append_data_section(buffer);
 	}
 
 	void append_type_section(ByteBuffer& buffer) const {
@@ -173,6 +245,64 @@ private:
 		buffer.append(content);
 	}
 
+	void append_memory_section(ByteBuffer& buffer) const {
+		if (memory_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, memory_entries_.size());
+		for (const MemoryType& memory : memory_entries_) {
+			append_varuint32(content, memory.min);
+			append_varuint32(content, memory.max);
+		}
+
+		buffer.append(SectionCode::MEMORY);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
+	void append_global_section(ByteBuffer& buffer) const {
+		if (global_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, global_entries_.size());
+		for (const GlobalEntry& global : global_entries_) {
+			content.append(global.type);
+			content.append(global.init);
+		}
+
+		buffer.append(SectionCode::GLOBAL);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
+	void append_const_section(ByteBuffer& buffer) const {
+		if (f32_entries_.size() == 0 && f64_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, f32_entries_.size());
+		for (float value : f32_entries_) {
+			content.append(value);
+		}
+
+		append_varuint32(content, f64_entries_.size());
+		for (double value : f64_entries_) {
+			content.append(value);
+		}
+
+		buffer.append(SectionCode::CONST);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
 	void append_code_section(ByteBuffer& buffer) const {
 		if (code_entries_.size() == 0) {
 			return;
@@ -190,9 +320,32 @@ private:
 		buffer.append(content);
 	}
 
+	void append_data_section(ByteBuffer& buffer) const {
+		if (data_entries_.size() == 0) {
+			return;
+		}
+
+		ByteBuffer content;
+
+		append_varuint32(content, data_entries_.size());
+		for (const auto& bytes : data_entries_) {
+			append_varuint32(content, bytes.size());
+			content.append(bytes.data(), bytes.size());
+		}
+
+		buffer.append(SectionCode::DATA);
+		append_varuint32(buffer, content.size());
+		buffer.append(content);
+	}
+
 	std::vector<FuncType> type_entries_;
 	std::vector<std::uint32_t> func_entries_;
+	std::vector<MemoryType> memory_entries_;
+	std::vector<GlobalEntry> global_entries_;
+	std::vector<float> f32_entries_;
+	std::vector<double> f64_entries_;
 	std::vector<CodeWriter> code_entries_;
+	std::vector<std::vector<Byte>> data_entries_;
 };
 
 template <typename M>
@@ -0,0 +1,228 @@
+#ifndef AB_SCHEDULER_HPP_
+#define AB_SCHEDULER_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Assert.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <Ab/WorkStealingDeque.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace Ab {
+
+class Scheduler;
+
+/// How a Scheduler is set up.
+///
+struct SchedulerConfig {
+	/// The number of worker threads. Zero for one per hardware thread.
+	///
+	std::size_t worker_count = 0;
+
+	/// How the context of every task is set up.
+	///
+	ContextConfig context;
+
+	/// The fuel a task is given each time it runs. A task which runs out is preempted, so a long
+	/// running task can't hold a worker while others wait. See UNLIMITED_FUEL.
+	///
+	std::int64_t time_slice = DEFAULT_TIME_SLICE;
+
+	static constexpr std::int64_t DEFAULT_TIME_SLICE = 100'000;
+};
+
+enum class TaskState { RUNNABLE, RUNNING, DONE, TRAPPED };
+
+/// A call into the interpreter, run by a Scheduler. Every task has a Context of it's own, which
+/// the scheduler moves between workers. Destroying a task waits for it to finish.
+///
+class Task {
+public:
+	Task(const Task&) = delete;
+
+	~Task() { wait(); }
+
+	/// Block until the call returns or traps.
+	///
+	void wait() const {
+		std::unique_lock<std::mutex> lock(mutex_);
+		finished_.wait(lock, [this] { return finished(); });
+	}
+
+	TaskState state() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return state_;
+	}
+
+	/// Wait for the call to finish, and get the values it returned. If the call trapped, throws a
+	/// TrapError.
+	///
+	template <typename... Rs>
+	std::tuple<Rs...> results() const {
+		AB_ASSERT((types_match<Rs...>(func_->type()->rets)));
+		wait();
+		if (state_ == TaskState::TRAPPED) {
+			throw TrapError(trap_kind_);
+		}
+		return get_stack_elements<Rs...>(ret_);
+	}
+
+	/// The number of times the task was suspended, by halting or running out of fuel, and resumed.
+	///
+	std::size_t resume_count() const {
+		wait();
+		return resume_count_;
+	}
+
+	FuncInst* func() const noexcept { return func_; }
+
+	/// Stop the task at it's next backward branch or call entry. The task traps, as INTERRUPTED.
+	/// See Context::interrupt.
+	///
+	void interrupt() noexcept { cx_.interrupt(); }
+
+private:
+	friend class Scheduler;
+
+	Task(VirtualMachine* vm, const ContextConfig& config, FuncInst* func)
+		: cx_(vm, config), func_(func) {}
+
+	bool finished() const noexcept {
+		return state_ == TaskState::DONE || state_ == TaskState::TRAPPED;
+	}
+
+	void set_state(TaskState state) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		state_ = state;
+		finished_.notify_all();
+	}
+
+	// The running state is only touched by the worker running the task. Handing the task between
+	// workers orders it.
+	Context cx_;
+	FuncInst* func_;
+	Byte* ret_                = nullptr;
+	TrapKind trap_kind_       = TrapKind::NONE;
+	std::size_t resume_count_ = 0;
+	bool started_             = false;
+
+	mutable std::mutex mutex_;
+	mutable std::condition_variable finished_;
+	TaskState state_ = TaskState::RUNNABLE;
+};
+
+/// Runs tasks on a pool of worker threads, one per core by default.
+///
+/// Each worker keeps a work-stealing deque of runnable tasks. A worker takes work from the bottom
+/// of it's own deque, then from the scheduler's injection queue, and failing that, steals from the
+/// top of another worker's deque. Workers with nothing to do sleep until work arrives.
+///
+/// A task runs until it returns, traps, halts, or uses up it's time slice of fuel. A halted or
+/// preempted task is suspended, and requeued at the back of the injection queue, behind every other
+/// runnable task. It is resumed later, on any worker, with a fresh time slice.
+///
+/// Destroying the scheduler runs every task to completion first.
+///
+class Scheduler {
+public:
+	explicit Scheduler(VirtualMachine* vm) : Scheduler(vm, SchedulerConfig()) {}
+
+	Scheduler(VirtualMachine* vm, const SchedulerConfig& config);
+
+	Scheduler(const Scheduler&) = delete;
+
+	~Scheduler();
+
+	/// Call a function with arguments As, on some worker. The arguments are checked against the
+	/// signature of the function, as with static_call. The task's context is created on the calling
+	/// thread.
+	///
+	/// If the interpreter stack is too small for the function, throws a TrapError.
+	///
+	template <typename... As>
+	std::unique_ptr<Task> spawn(FuncInst* func, As... as) {
+		AB_ASSERT((types_match<As...>(func->type()->args)));
+
+		std::unique_ptr<Task> task(new Task(vm_, config_.context, func));
+
+		if (!has_stack_for(task->cx_, func)) {
+			task->trap_kind_ = TrapKind::STACK_OVERFLOW;
+			task->state_     = TaskState::TRAPPED;
+			throw TrapError(TrapKind::STACK_OVERFLOW);
+		}
+
+		Byte* reg_ptr = enter_native_frame(task->cx_, func->nregs());
+		set_stack_elements<As...>(reg_ptr, as...);
+
+		pending_.fetch_add(1);
+		submit(task.get());
+		return task;
+	}
+
+	VirtualMachine* vm() const noexcept { return vm_; }
+
+	std::size_t worker_count() const noexcept { return workers_.size(); }
+
+private:
+	struct Worker {
+		WorkStealingDeque<Task*> deque;
+		std::thread thread;
+	};
+
+	/// Queue a runnable task on the injection queue, and wake a worker for it.
+	///
+	void submit(Task* task);
+
+	void work(std::size_t index);
+
+	/// Find a runnable task for a worker. Null if there is none.
+	///
+	Task* find_task(std::size_t index, std::uint32_t& seed);
+
+	/// Move a share of the injection queue into the worker's deque, and take one task. Null if the
+	/// queue is empty. The caller must hold the mutex.
+	///
+	Task* take_injected(std::size_t index);
+
+	/// Steal a task from another worker, starting from a random victim.
+	///
+	Task* steal(std::size_t index, std::uint32_t& seed);
+
+	/// Sleep until a task can be found. Null if the scheduler is shutting down, and every task has
+	/// finished.
+	///
+	Task* sleep(std::size_t index, std::uint32_t& seed);
+
+	/// Wake a sleeping worker, if any.
+	///
+	void wake_one();
+
+	/// Run a task until it finishes or suspends.
+	///
+	void run(Task* task);
+
+	VirtualMachine* vm_;
+	SchedulerConfig config_;
+	std::vector<std::unique_ptr<Worker>> workers_;
+
+	std::mutex mutex_;
+	std::condition_variable wake_;
+	std::deque<Task*> injected_;
+	std::size_t signals_ = 0;
+	bool stopping_       = false;
+
+	std::atomic<std::size_t> sleepers_ = 0;
+	std::atomic<std::size_t> pending_  = 0;  ///< Tasks spawned but not finished.
+};
+
+}  // namespace Ab
+
+#endif  // AB_SCHEDULER_HPP_
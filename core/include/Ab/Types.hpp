@@ -13,6 +13,10 @@ namespace Ab {
 ///
 constexpr std::size_t SIZEOF_SLOT = 4;
 
+/// The most registers a function may have. Register immediates are at most 16 bits wide.
+///
+constexpr std::size_t MAX_NREGS = 0x10000;
+
 template <ValType V>
 struct val_type_constant : public std::integral_constant<ValType, V> {};
 
@@ -280,6 +284,33 @@ public:
 	std::vector<ValType> rets;
 };
 
+/// A global variable, and it's initial value.
+/// Every global is stored in a 64-bit slot. A 32-bit global is held in the low half.
+///
+struct GlobalEntry final {
+	bool operator==(const GlobalEntry& rhs) const noexcept {
+		return type == rhs.type && init == rhs.init;
+	}
+
+	bool operator!=(const GlobalEntry& rhs) const noexcept { return !(*this == rhs); }
+
+	ValType type;
+	std::uint64_t init;
+};
+
+/// A linear memory, and it's limits, in pages. See LinearMemory.
+///
+struct MemoryType final {
+	bool operator==(const MemoryType& rhs) const noexcept {
+		return min == rhs.min && max == rhs.max;
+	}
+
+	bool operator!=(const MemoryType& rhs) const noexcept { return !(*this == rhs); }
+
+	std::uint32_t min;
+	std::uint32_t max;
+};
+
 }  // namespace Ab
 
 template <>
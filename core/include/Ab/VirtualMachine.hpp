@@ -1,16 +1,17 @@
 #ifndef AB_VIRTUALMACHINE_HPP_
 #define AB_VIRTUALMACHINE_HPP_
 
-#define AB_DEBUG
-
 #include <Ab/Config.hpp>
 #include <Ab/Assert.hpp>
 #include <Ab/Debug.hpp>
 #include <Ab/Interpreter.hpp>
 #include <Ab/IntrusiveList.hpp>
 #include <Ab/LinearMemory.hpp>
+#include <Ab/LockGuard.hpp>
 #include <Ab/Module.hpp>
+#include <Ab/Process.hpp>
 #include <Ab/Runtime.hpp>
+#include <Ab/SharedLock.hpp>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -26,15 +27,21 @@ class ModuleInst;
 using ContextList     = IntrusiveList<Context>;
 using ContextListNode = IntrusiveListNode<Context>;
 
-/// The global state of the Abigail VM.
+/// The global state of the Abigail VM. Contexts attach, detach, and register instances from any
+/// thread, under the VM's lock. The lock is reader-biased: walking the contexts or instances is
+/// cheap, and never blocks another walk. See SharedLock.
 ///
 class VirtualMachine {
 public:
 	VirtualMachine(Runtime* runtime) : runtime_(runtime) {}
 
-	VirtualMachine(const VirtualMachine&) = delete;
+	/// A VM with a pool of linear memory slots, reserved up front. Instances take their memory from
+	/// the pool.
+	///
+	VirtualMachine(Runtime* runtime, const LinearMemoryPoolConfig& pool_config)
+		: runtime_(runtime), memory_pool_(std::make_unique<LinearMemoryPool>(pool_config)) {}
 
-	VirtualMachine(VirtualMachine&&) noexcept = default;
+	VirtualMachine(const VirtualMachine&) = delete;
 
 	// const std::vector<Module>& modules() const { return modules_; }
 
@@ -48,22 +55,96 @@ public:
 
 	const LinearMemory& linear_memory() const noexcept { return linear_memory_; }
 
+	/// The pool of linear memory slots, or null if the VM has none.
+	///
+	LinearMemoryPool* memory_pool() const noexcept { return memory_pool_.get(); }
+
+	/// Guards the context list and the instances owned by the VM.
+	///
+	SharedLock& lock() const noexcept { return lock_; }
+
+	/// The contexts attached to the VM. Hold the lock while using the list, see lock().
+	///
 	ContextList& context_list() noexcept { return context_list_; }
 
 	const ContextList& context_list() const noexcept { return context_list_; }
 
+	/// Call f on every attached context, with shared access. f must not create or destroy a
+	/// Context, or add a module: those take exclusive access, and the lock can't be upgraded, so
+	/// the thread would deadlock waiting on itself.
+	///
+	template <typename F>
+	void for_each_context(F&& f) const {
+		SharedLockGuard<SharedLock> guard(lock_);
+		for (Context& cx : context_list_) {
+			f(cx);
+		}
+	}
+
+	/// Hand an instance to the VM. The instance lives until the VM is destroyed.
+	///
+	ModuleInst* add_module(std::unique_ptr<ModuleInst> inst) {
+		ExclusiveLockGuard<SharedLock> guard(lock_);
+		modules_.push_back(std::move(inst));
+		return modules_.back().get();
+	}
+
+	/// The number of instances owned by the VM.
+	///
+	std::size_t module_count() const {
+		SharedLockGuard<SharedLock> guard(lock_);
+		return modules_.size();
+	}
+
 private:
 	Runtime* runtime_;
+	mutable SharedLock lock_;
 	std::vector<std::unique_ptr<ModuleInst>> modules_;
 	LinearMemory linear_memory_;
+	std::unique_ptr<LinearMemoryPool> memory_pool_;
 	ContextList context_list_;
 };
 
-/// Thread-local VM context.
+/// How a Context is set up.
+///
+struct ContextConfig {
+	/// How the interpreter stack is allocated.
+	///
+	StackConfig stack;
+
+	/// How the interpreter stack, and the memory of every instance created through the context,
+	/// are placed on the NUMA node of the CPU the context is created on. Remote memory is much
+	/// slower to access, and the first touch of a page may come from another node, if the thread
+	/// has migrated.
+	///
+	NumaPolicy numa_policy = NumaPolicy::DEFAULT;
+
+	/// Restrict the creating thread to the CPUs of it's NUMA node, so it stays local to it's
+	/// memory. The pinning outlives the context.
+	///
+	bool pin_thread = false;
+};
+
+/// VM context. A context is used by one thread at a time, but may move between threads while
+/// it's execution is suspended. See Scheduler.
 ///
 class Context {
 public:
-	explicit Context(VirtualMachine* vm) : vm_(vm) { enter(); }
+	explicit Context(VirtualMachine* vm) : Context(vm, ContextConfig()) {}
+
+	Context(VirtualMachine* vm, const ContextConfig& config)
+		: vm_(vm)
+		, interpreter_(config.stack)
+		, numa_node_(Process::current_numa_node())
+		, numa_policy_(config.numa_policy) {
+		if (config.pin_thread) {
+			Process::pin_thread_to_numa_node(numa_node_);
+		}
+		if (numa_policy_ != NumaPolicy::DEFAULT) {
+			interpreter_.stack().bind(numa_node_, numa_policy_);
+		}
+		enter();
+	}
 
 	Context(const Context&) = delete;
 
@@ -87,6 +168,44 @@ public:
 
 	const ExecState& exec_state() const noexcept { return interpreter_.exec_state(); }
 
+	/// The fuel left. See UNLIMITED_FUEL.
+	///
+	std::int64_t fuel() const noexcept { return exec_state().st_b.fuel; }
+
+	/// Limit how long the interpreter runs, before yielding. Execution which runs out of fuel is
+	/// suspended, and continues where it stopped once refueled and resumed. See resume_interpreter.
+	///
+	void set_fuel(std::int64_t fuel) noexcept { exec_state().st_b.fuel = fuel; }
+
+	/// Stop execution at the next backward branch or call entry, with an INTERRUPTED trap. Any
+	/// thread may interrupt a context, at any time. An interrupt made while the context is idle
+	/// stops it's next call. See Watchdog.
+	///
+	void interrupt() noexcept {
+		interrupt_word(&exec_state()).store(1, std::memory_order_relaxed);
+	}
+
+	/// Withdraw an interrupt which has not been taken.
+	///
+	void clear_interrupt() noexcept {
+		interrupt_word(&exec_state()).store(0, std::memory_order_relaxed);
+	}
+
+	/// The NUMA node the context was created on.
+	///
+	unsigned numa_node() const noexcept { return numa_node_; }
+
+	NumaPolicy numa_policy() const noexcept { return numa_policy_; }
+
+	/// Place an instance's memory on the context's NUMA node, under the context's policy.
+	///
+	void place(ModuleInst& inst) const noexcept {
+		LinearMemory* memory = inst.memory();
+		if (memory != nullptr && numa_policy_ != NumaPolicy::DEFAULT) {
+			memory->bind(numa_node_, numa_policy_);
+		}
+	}
+
 	ContextListNode& node() noexcept { return node_; }
 
 	const ContextListNode& node() const noexcept { return node_; }
@@ -94,12 +213,20 @@ public:
 private:
 	VirtualMachine* vm_;
 	Interpreter interpreter_;
+	unsigned numa_node_;
+	NumaPolicy numa_policy_;
 	ContextListNode node_;
 };
 
-inline void VirtualMachine::enter(Context* cx) { context_list_.add(cx); }
+inline void VirtualMachine::enter(Context* cx) {
+	ExclusiveLockGuard<SharedLock> guard(lock_);
+	context_list_.add(cx);
+}
 
-inline void VirtualMachine::leave(Context* cx) { context_list_.remove(cx); }
+inline void VirtualMachine::leave(Context* cx) {
+	ExclusiveLockGuard<SharedLock> guard(lock_);
+	context_list_.remove(cx);
+}
 
 template <typename T>
 void set_stack_element(Byte* ptr, T x) noexcept {
@@ -147,6 +274,11 @@ void set_stack_elements(Byte* base, Ts... xs) noexcept {
 ///
 Byte* enter_native_frame(Context& cx, std::size_t nregs);
 
+/// True if the interpreter stack has room to call the function from native code. When the stack
+/// depth of the function is bounded, this covers every call beneath it. See FrameInfo.
+///
+bool has_stack_for(Context& cx, const FuncInst* func) noexcept;
+
 /// Remove a top-level frame from the interpreter stack.
 ///
 /// The interpreter, when encountering a top-level frame, returns to the c-caller.
@@ -166,6 +298,25 @@ Byte* leave_native_frame(Context& cx, std::size_t nregs);
 ///
 Byte* enter_interpreter(Context& cx, FuncInst* func);
 
+/// Continue suspended execution, from exactly where it stopped: after a halt instruction, or at
+/// the branch target or callee entry where the fuel ran out.
+///
+/// Execution suspends with it's frames on the interpreter stack, above the native frame which
+/// entered the interpreter, and the context in the SUSPENDED condition. The native frame must
+/// still be in place. Resuming may happen on any thread, but a suspended context must not be
+/// entered again until it has been resumed to completion. If the fuel ran out, refuel first, or
+/// execution yields again at the next backward branch or call.
+///
+/// @returns A pointer to the register vector holding the result, as with enter_interpreter.
+///
+Byte* resume_interpreter(Context& cx);
+
+/// Discard suspended execution, popping it's frames down to the native frame which entered the
+/// interpreter. The native frame is left in place, for the caller to leave, and the context is
+/// left HALTED.
+///
+void abandon_interpreter(Context& cx);
+
 /// Call a function with arguments As returning values Rs in a tuple.
 ///
 /// The signature will be validated at runtime, and must match the signature
@@ -174,17 +325,38 @@ Byte* enter_interpreter(Context& cx, FuncInst* func);
 ///
 /// It is safe to recursively static-call into the interpreter from a native.
 ///
+/// If execution traps, the native frame is removed, and a TrapError is thrown. If execution
+/// suspends, at a halt or when the fuel runs out, it's frames and the native frame are removed,
+/// and a SuspendedError is thrown. Functions which may suspend must be entered and resumed
+/// explicitly, see resume_interpreter, or run by a Scheduler.
+///
 template <typename... Rs, typename... As>
 std::tuple<Rs...> static_call(Context& cx, FuncInst* func, As... as) {
 	const FuncType& func_type = *func->type();
 	AB_ASSERT((types_match<As...>(func_type.args)));
 	AB_ASSERT((types_match<Rs...>(func_type.rets)));
 
+	if (!has_stack_for(cx, func)) {
+		throw TrapError(TrapKind::STACK_OVERFLOW);
+	}
+
 	auto reg_ptr = enter_native_frame(cx, func->nregs());
 	set_stack_elements<As...>(reg_ptr, as...);
 
 	auto ret_ptr = enter_interpreter(cx, func);
 
+	if (cx.exec_state().st_b.condition == ExecCond::SUSPENDED) {
+		abandon_interpreter(cx);
+		leave_native_frame(cx, func->nregs());
+		throw SuspendedError();
+	}
+
+	if (cx.exec_state().st_b.flags.trap) {
+		TrapKind kind = clear_trap(&cx.exec_state());
+		leave_native_frame(cx, func->nregs());
+		throw TrapError(kind);
+	}
+
 	auto ret = get_stack_elements<Rs...>(ret_ptr);
 	leave_native_frame(cx, func->nregs());
 
@@ -0,0 +1,88 @@
+#ifndef AB_WATCHDOG_HPP_
+#define AB_WATCHDOG_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace Ab {
+
+/// Enforces wall-clock deadlines on guest execution. A thread of it's own sleeps until the next
+/// deadline, then interrupts the context, which traps as INTERRUPTED at it's next backward branch
+/// or call entry. No signals are involved. See Context::interrupt.
+///
+class Watchdog {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// Identifies an armed deadline.
+	///
+	using Ticket = std::uint64_t;
+
+	Watchdog();
+
+	Watchdog(const Watchdog&) = delete;
+
+	~Watchdog();
+
+	/// Interrupt the context at the deadline, unless disarmed first.
+	///
+	Ticket arm(Context& cx, Clock::time_point deadline);
+
+	/// Cancel a deadline. Once this returns, the deadline will not fire. Returns true if it already
+	/// had, and interrupted the context.
+	///
+	bool disarm(Ticket ticket);
+
+	/// The number of deadlines which have fired.
+	///
+	std::uint64_t fired() const;
+
+private:
+	void run();
+
+	mutable std::mutex mutex_;
+	std::condition_variable changed_;
+	std::set<std::pair<Clock::time_point, Ticket>> deadlines_;  ///< Ordered by deadline.
+	std::map<Ticket, std::pair<Clock::time_point, Context*>> armed_;
+	Ticket next_ticket_  = 0;
+	std::uint64_t fired_ = 0;
+	bool stopping_       = false;
+	std::thread thread_;
+};
+
+/// Bounds the execution of a context, for the lifetime of the deadline. On destruction, the
+/// deadline is disarmed. If it fired, any interrupt the context did not take is withdrawn, so it
+/// can't stop a later call. An interrupt from anywhere else is left pending.
+///
+class Deadline {
+public:
+	Deadline(Watchdog& watchdog, Context& cx, Watchdog::Clock::duration timeout)
+		: watchdog_(watchdog)
+		, cx_(cx)
+		, ticket_(watchdog.arm(cx, Watchdog::Clock::now() + timeout)) {}
+
+	Deadline(const Deadline&) = delete;
+
+	~Deadline() {
+		if (watchdog_.disarm(ticket_)) {
+			cx_.clear_interrupt();
+		}
+	}
+
+private:
+	Watchdog& watchdog_;
+	Context& cx_;
+	Watchdog::Ticket ticket_;
+};
+
+}  // namespace Ab
+
+#endif  // AB_WATCHDOG_HPP_
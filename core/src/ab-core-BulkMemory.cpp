@@ -0,0 +1,372 @@
+#include <Ab/BulkMemory.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace Ab {
+
+namespace {
+
+/// True if the source and destination of a copy overlap. Overlapping copies are left to memmove,
+/// the vector kernels store the first and last vectors of a copy out of order.
+///
+bool overlaps(const Byte* dst, const Byte* src, std::size_t n) noexcept {
+	auto d = reinterpret_cast<std::uintptr_t>(dst);
+	auto s = reinterpret_cast<std::uintptr_t>(src);
+	return d < s + n && s < d + n;
+}
+
+#if defined(__x86_64__)
+
+///
+/// Vector Kernels
+///
+/// Every kernel has the same shape. The first and last vectors are stored unaligned, and the
+/// vectors between them are stored aligned, four at a time, so no store ever splits a cache line.
+/// Large ranges are stored non-temporally, and fenced before returning. A range shorter than four
+/// vectors is left to memmove or memset.
+///
+
+__attribute__((target("sse2"))) void copy_sse2(Byte* dst, const Byte* src, std::size_t n) noexcept {
+	using V                 = __m128i;
+	constexpr std::size_t W = sizeof(V);
+
+	if (n < 4 * W || overlaps(dst, src, n)) {
+		std::memmove(dst, src, n);
+		return;
+	}
+
+	const V head = _mm_loadu_si128(reinterpret_cast<const V*>(src));
+	const V tail = _mm_loadu_si128(reinterpret_cast<const V*>(src + n - W));
+
+	std::size_t i = W - (reinterpret_cast<std::uintptr_t>(dst) & (W - 1));
+
+	if (n >= BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			V a = _mm_loadu_si128(reinterpret_cast<const V*>(src + i));
+			V b = _mm_loadu_si128(reinterpret_cast<const V*>(src + i + W));
+			V c = _mm_loadu_si128(reinterpret_cast<const V*>(src + i + 2 * W));
+			V d = _mm_loadu_si128(reinterpret_cast<const V*>(src + i + 3 * W));
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i), a);
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i + W), b);
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i + 2 * W), c);
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i + 3 * W), d);
+		}
+		_mm_sfence();
+	} else {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			V a = _mm_loadu_si128(reinterpret_cast<const V*>(src + i));
+			V b = _mm_loadu_si128(reinterpret_cast<const V*>(src + i + W));
+			V c = _mm_loadu_si128(reinterpret_cast<const V*>(src + i + 2 * W));
+			V d = _mm_loadu_si128(reinterpret_cast<const V*>(src + i + 3 * W));
+			_mm_store_si128(reinterpret_cast<V*>(dst + i), a);
+			_mm_store_si128(reinterpret_cast<V*>(dst + i + W), b);
+			_mm_store_si128(reinterpret_cast<V*>(dst + i + 2 * W), c);
+			_mm_store_si128(reinterpret_cast<V*>(dst + i + 3 * W), d);
+		}
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm_store_si128(
+			reinterpret_cast<V*>(dst + i), _mm_loadu_si128(reinterpret_cast<const V*>(src + i)));
+	}
+
+	_mm_storeu_si128(reinterpret_cast<V*>(dst), head);
+	_mm_storeu_si128(reinterpret_cast<V*>(dst + n - W), tail);
+}
+
+__attribute__((target("sse2"))) void fill_sse2(Byte* dst, Byte value, std::size_t n) noexcept {
+	using V                 = __m128i;
+	constexpr std::size_t W = sizeof(V);
+
+	if (n < 4 * W) {
+		std::memset(dst, value, n);
+		return;
+	}
+
+	const V v = _mm_set1_epi8(char(value));
+
+	std::size_t i = W - (reinterpret_cast<std::uintptr_t>(dst) & (W - 1));
+
+	if (n >= BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i), v);
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i + W), v);
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i + 2 * W), v);
+			_mm_stream_si128(reinterpret_cast<V*>(dst + i + 3 * W), v);
+		}
+		_mm_sfence();
+	} else {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			_mm_store_si128(reinterpret_cast<V*>(dst + i), v);
+			_mm_store_si128(reinterpret_cast<V*>(dst + i + W), v);
+			_mm_store_si128(reinterpret_cast<V*>(dst + i + 2 * W), v);
+			_mm_store_si128(reinterpret_cast<V*>(dst + i + 3 * W), v);
+		}
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm_store_si128(reinterpret_cast<V*>(dst + i), v);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<V*>(dst), v);
+	_mm_storeu_si128(reinterpret_cast<V*>(dst + n - W), v);
+}
+
+__attribute__((target("avx2"))) void copy_avx2(Byte* dst, const Byte* src, std::size_t n) noexcept {
+	using V                 = __m256i;
+	constexpr std::size_t W = sizeof(V);
+
+	if (n < 4 * W || overlaps(dst, src, n)) {
+		std::memmove(dst, src, n);
+		return;
+	}
+
+	const V head = _mm256_loadu_si256(reinterpret_cast<const V*>(src));
+	const V tail = _mm256_loadu_si256(reinterpret_cast<const V*>(src + n - W));
+
+	std::size_t i = W - (reinterpret_cast<std::uintptr_t>(dst) & (W - 1));
+
+	if (n >= BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			V a = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i));
+			V b = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i + W));
+			V c = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i + 2 * W));
+			V d = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i + 3 * W));
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i), a);
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i + W), b);
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i + 2 * W), c);
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i + 3 * W), d);
+		}
+		_mm_sfence();
+	} else {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			V a = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i));
+			V b = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i + W));
+			V c = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i + 2 * W));
+			V d = _mm256_loadu_si256(reinterpret_cast<const V*>(src + i + 3 * W));
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i), a);
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i + W), b);
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i + 2 * W), c);
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i + 3 * W), d);
+		}
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm256_store_si256(
+			reinterpret_cast<V*>(dst + i), _mm256_loadu_si256(reinterpret_cast<const V*>(src + i)));
+	}
+
+	_mm256_storeu_si256(reinterpret_cast<V*>(dst), head);
+	_mm256_storeu_si256(reinterpret_cast<V*>(dst + n - W), tail);
+}
+
+__attribute__((target("avx2"))) void fill_avx2(Byte* dst, Byte value, std::size_t n) noexcept {
+	using V                 = __m256i;
+	constexpr std::size_t W = sizeof(V);
+
+	if (n < 4 * W) {
+		std::memset(dst, value, n);
+		return;
+	}
+
+	const V v = _mm256_set1_epi8(char(value));
+
+	std::size_t i = W - (reinterpret_cast<std::uintptr_t>(dst) & (W - 1));
+
+	if (n >= BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i), v);
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i + W), v);
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i + 2 * W), v);
+			_mm256_stream_si256(reinterpret_cast<V*>(dst + i + 3 * W), v);
+		}
+		_mm_sfence();
+	} else {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i), v);
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i + W), v);
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i + 2 * W), v);
+			_mm256_store_si256(reinterpret_cast<V*>(dst + i + 3 * W), v);
+		}
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm256_store_si256(reinterpret_cast<V*>(dst + i), v);
+	}
+
+	_mm256_storeu_si256(reinterpret_cast<V*>(dst), v);
+	_mm256_storeu_si256(reinterpret_cast<V*>(dst + n - W), v);
+}
+
+__attribute__((target("avx512f"))) void
+copy_avx512(Byte* dst, const Byte* src, std::size_t n) noexcept {
+	using V                 = __m512i;
+	constexpr std::size_t W = sizeof(V);
+
+	if (n < 4 * W || overlaps(dst, src, n)) {
+		std::memmove(dst, src, n);
+		return;
+	}
+
+	const V head = _mm512_loadu_si512(src);
+	const V tail = _mm512_loadu_si512(src + n - W);
+
+	std::size_t i = W - (reinterpret_cast<std::uintptr_t>(dst) & (W - 1));
+
+	if (n >= BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			V a = _mm512_loadu_si512(src + i);
+			V b = _mm512_loadu_si512(src + i + W);
+			V c = _mm512_loadu_si512(src + i + 2 * W);
+			V d = _mm512_loadu_si512(src + i + 3 * W);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i), a);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i + W), b);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i + 2 * W), c);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i + 3 * W), d);
+		}
+		_mm_sfence();
+	} else {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			V a = _mm512_loadu_si512(src + i);
+			V b = _mm512_loadu_si512(src + i + W);
+			V c = _mm512_loadu_si512(src + i + 2 * W);
+			V d = _mm512_loadu_si512(src + i + 3 * W);
+			_mm512_store_si512(dst + i, a);
+			_mm512_store_si512(dst + i + W, b);
+			_mm512_store_si512(dst + i + 2 * W, c);
+			_mm512_store_si512(dst + i + 3 * W, d);
+		}
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm512_store_si512(dst + i, _mm512_loadu_si512(src + i));
+	}
+
+	_mm512_storeu_si512(dst, head);
+	_mm512_storeu_si512(dst + n - W, tail);
+}
+
+__attribute__((target("avx512f"))) void fill_avx512(Byte* dst, Byte value, std::size_t n) noexcept {
+	using V                 = __m512i;
+	constexpr std::size_t W = sizeof(V);
+
+	if (n < 4 * W) {
+		std::memset(dst, value, n);
+		return;
+	}
+
+	const V v = _mm512_set1_epi8(char(value));
+
+	std::size_t i = W - (reinterpret_cast<std::uintptr_t>(dst) & (W - 1));
+
+	if (n >= BULK_MEMORY_NON_TEMPORAL_SIZE) {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i), v);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i + W), v);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i + 2 * W), v);
+			_mm512_stream_si512(reinterpret_cast<V*>(dst + i + 3 * W), v);
+		}
+		_mm_sfence();
+	} else {
+		for (; i + 4 * W <= n; i += 4 * W) {
+			_mm512_store_si512(dst + i, v);
+			_mm512_store_si512(dst + i + W, v);
+			_mm512_store_si512(dst + i + 2 * W, v);
+			_mm512_store_si512(dst + i + 3 * W, v);
+		}
+	}
+
+	for (; i + W <= n; i += W) {
+		_mm512_store_si512(dst + i, v);
+	}
+
+	_mm512_storeu_si512(dst, v);
+	_mm512_storeu_si512(dst + n - W, v);
+}
+
+#endif  // __x86_64__
+
+BulkMemoryKernel select_kernel() noexcept {
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return BulkMemoryKernel::AVX512;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		return BulkMemoryKernel::AVX2;
+	}
+	return BulkMemoryKernel::SSE2;
+#else
+	return BulkMemoryKernel::GENERIC;
+#endif
+}
+
+/// The selected kernel. Zero initialized to GENERIC, so a copy made by another static initializer
+/// before the selection is still correct.
+///
+BulkMemoryKernel selected_kernel = select_kernel();
+
+}  // namespace
+
+bool supports(BulkMemoryKernel kernel) noexcept {
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	switch (kernel) {
+	case BulkMemoryKernel::AVX512:
+		return __builtin_cpu_supports("avx512f");
+	case BulkMemoryKernel::AVX2:
+		return __builtin_cpu_supports("avx2");
+	default:
+		return true;
+	}
+#else
+	return kernel == BulkMemoryKernel::GENERIC;
+#endif
+}
+
+BulkMemoryKernel bulk_memory_kernel() noexcept { return selected_kernel; }
+
+void copy_bytes(BulkMemoryKernel kernel, Byte* dst, const Byte* src, std::size_t n) noexcept {
+	switch (kernel) {
+#if defined(__x86_64__)
+	case BulkMemoryKernel::SSE2:
+		copy_sse2(dst, src, n);
+		break;
+	case BulkMemoryKernel::AVX2:
+		copy_avx2(dst, src, n);
+		break;
+	case BulkMemoryKernel::AVX512:
+		copy_avx512(dst, src, n);
+		break;
+#endif
+	default:
+		std::memmove(dst, src, n);
+		break;
+	}
+}
+
+void fill_bytes(BulkMemoryKernel kernel, Byte* dst, Byte value, std::size_t n) noexcept {
+	switch (kernel) {
+#if defined(__x86_64__)
+	case BulkMemoryKernel::SSE2:
+		fill_sse2(dst, value, n);
+		break;
+	case BulkMemoryKernel::AVX2:
+		fill_avx2(dst, value, n);
+		break;
+	case BulkMemoryKernel::AVX512:
+		fill_avx512(dst, value, n);
+		break;
+#endif
+	default:
+		std::memset(dst, value, n);
+		break;
+	}
+}
+
+}  // namespace Ab
@@ -1,10 +1,16 @@
 #include <Ab/Loading.hpp>
+#include <Ab/Opcode.hpp>
 #include <Ab/VectorUtilities.hpp>
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <span>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace Ab {
 
@@ -108,13 +114,17 @@ public:
 
 	std::uint32_t read_u32() { return read<std::uint32_t>(); }
 
-	std::uint32_t read_u64() { return read<std::uint64_t>(); }
+	std::uint64_t read_u64() { return read<std::uint64_t>(); }
 
 	std::int8_t read_i8() { return read<std::int8_t>(); }
 
 	std::int32_t read_i32() { return read<std::int32_t>(); }
 
-	std::int32_t read_i64() { return read<std::int64_t>(); }
+	std::int64_t read_i64() { return read<std::int64_t>(); }
+
+	float read_f32() { return read<float>(); }
+
+	double read_f64() { return read<double>(); }
 
 	SectionCode read_section_code() {
 		SectionCode code = read<SectionCode>();
@@ -188,6 +198,69 @@ void decode_func_section(Context& cx, Module& module, Decoder& decoder, std::uin
 	}
 }
 
+void decode_memory_section(Context&, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nmemories = decoder.read_varu32();
+	if (nmemories > 1) {
+		throw DecodeError("Too many memories");
+	}
+
+	for (std::size_t i = 0; i < nmemories; ++i) {
+		MemoryType& memory = push(module.memory_table());
+		memory.min         = decoder.read_varu32();
+		memory.max         = decoder.read_varu32();
+
+		if (memory.max < memory.min || LinearMemoryConfig::MAX_PAGE_COUNT < memory.max) {
+			throw DecodeError("Invalid memory limits");
+		}
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+void decode_global_section(Context&, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nglobals = decoder.read_varu32();
+	module.global_table().reserve(nglobals);
+
+	for (std::size_t i = 0; i < nglobals; ++i) {
+		GlobalEntry& global = push(module.global_table());
+		global.type         = decoder.read_val_type();
+		global.init         = decoder.read_u64();
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+void decode_const_section(Context&, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nf32 = decoder.read_varu32();
+	module.f32_table().reserve(nf32);
+	for (std::size_t i = 0; i < nf32; ++i) {
+		module.f32_table().push_back(decoder.read_f32());
+	}
+
+	std::uint32_t nf64 = decoder.read_varu32();
+	module.f64_table().reserve(nf64);
+	for (std::size_t i = 0; i < nf64; ++i) {
+		module.f64_table().push_back(decoder.read_f64());
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
 void decode_code_section(Context& cx, Module& module, Decoder& decoder, std::uint32_t size) {
 	Byte* start = decoder.position();
 
@@ -204,8 +277,164 @@ void decode_code_section(Context& cx, Module& module, Decoder& decoder, std::uin
 		Byte* start         = decoder.position();
 		std::uint32_t nregs = decoder.read_varu32();
 		Byte* body          = decoder.position();
+
+		std::uint32_t arg_nregs = module.type_for(i).arg_nregs();
+
+		if (MAX_NREGS < arg_nregs || MAX_NREGS - arg_nregs < nregs) {
+			throw DecodeError("Too many registers");
+		}
+
 		decoder.reposition(start + size);
-		module.func_table().emplace_back(&module.type_for(i), body, nregs);
+		module.func_table().emplace_back(
+			&module.type_for(i), std::span<Byte>(body, decoder.position()), nregs);
+	}
+}
+
+/// Decode the data section. Segments are passive: they are only copied into memory by
+/// `memory.init`, and are kept as views of the module's bytes.
+///
+void decode_data_section(Context&, Module& module, Decoder& decoder, std::uint32_t size) {
+	Byte* start = decoder.position();
+
+	std::uint32_t nsegments = decoder.read_varu32();
+	module.data_table().reserve(nsegments);
+
+	for (std::size_t i = 0; i < nsegments; ++i) {
+		std::uint32_t nbytes = decoder.read_varu32();
+		Byte* bytes          = decoder.position();
+
+		if (std::size_t(decoder.end() - bytes) < nbytes) {
+			throw DecodeError("Data segment runs past the end of the module");
+		}
+
+		decoder.reposition(bytes + nbytes);
+		module.data_table().emplace_back(bytes, nbytes);
+	}
+
+	Byte* end = decoder.position();
+	if (end - start != size) {
+		throw DecodeError("Section is the wrong size");
+	}
+}
+
+/// Reject memory operators in a module without a memory. Handlers do not check for a memory, see
+/// LinearMemory.
+///
+void verify_memory_access(Module& module) {
+	if (!module.memory_table().empty()) {
+		return;
+	}
+
+	for (Func& func : module.func_table()) {
+		std::span<Byte> body = func.body_bytes();
+		std::size_t offset   = 0;
+
+		while (offset < body.size()) {
+			std::size_t size = sizeof_insn(body, offset);
+			bool wide        = Opcode(body[offset]) == Opcode::WIDE;
+
+			if (size == 0) {
+				throw DecodeError("Invalid opcode");
+			}
+
+			if (uses_memory(Opcode(body[offset + (wide ? 1 : 0)]))) {
+				throw DecodeError("Memory access without a memory");
+			}
+
+			offset += size;
+		}
+	}
+}
+
+/// Find the stack usage of every function in the module. See FrameInfo.
+///
+/// The direct calls of each function form a call graph. A function's stack depth is bounded if it
+/// makes no indirect calls, and no cycle in the graph is reachable from it. The graph is walked
+/// depth first, without recursion, and every function is finished after it's callees. A callee
+/// that is still open when reached closes a cycle.
+///
+void analyze_frames(Module& module) {
+	auto& funcs        = module.func_table();
+	std::size_t nfuncs = funcs.size();
+
+	std::vector<std::vector<std::size_t>> callees(nfuncs);
+	std::vector<bool> bounded(nfuncs, true);
+
+	for (std::size_t i = 0; i < nfuncs; ++i) {
+		std::span<Byte> body = funcs[i].body_bytes();
+		std::size_t offset   = 0;
+
+		funcs[i].frame_info().frame_size = sizeof(NormalFrame) + funcs[i].nreg_bytes();
+
+		while (offset < body.size()) {
+			std::size_t size = sizeof_insn(body, offset);
+			bool wide        = Opcode(body[offset]) == Opcode::WIDE;
+			Opcode op        = Opcode(body[offset + (wide ? 1 : 0)]);
+
+			if (size == 0) {
+				throw DecodeError("Invalid opcode");
+			}
+
+			if (op == Opcode::CALL) {
+				std::size_t imm   = wide ? WIDE_CALL_FUNCTION_INDEX_OFFSET : CALL_FUNCTION_INDEX_OFFSET;
+				std::uint32_t tgt = 0;
+				std::memcpy(&tgt, body.data() + offset + imm, sizeof(tgt));
+				if (tgt < nfuncs) {
+					callees[i].push_back(tgt);
+				} else {
+					bounded[i] = false;  // traps when executed.
+				}
+			} else if (op == Opcode::CALL_INDIRECT) {
+				bounded[i] = false;
+			}
+
+			offset += size;
+		}
+	}
+
+	enum class Mark : std::uint8_t { NEW, OPEN, DONE };
+
+	std::vector<Mark> marks(nfuncs, Mark::NEW);
+	std::vector<std::pair<std::size_t, std::size_t>> walk;  // function, next callee to visit.
+
+	for (std::size_t root = 0; root < nfuncs; ++root) {
+		if (marks[root] != Mark::NEW) {
+			continue;
+		}
+
+		marks[root] = Mark::OPEN;
+		walk.emplace_back(root, 0);
+
+		while (!walk.empty()) {
+			auto& [f, next] = walk.back();
+
+			if (next < callees[f].size()) {
+				std::size_t g = callees[f][next++];
+				if (marks[g] == Mark::NEW) {
+					marks[g] = Mark::OPEN;
+					walk.emplace_back(g, 0);
+				} else if (marks[g] == Mark::OPEN) {
+					bounded[f] = false;  // f closes a cycle.
+				}
+				continue;
+			}
+
+			std::uint64_t depth = 0;
+			for (std::size_t g : callees[f]) {
+				bounded[f] = bounded[f] && bounded[g];
+				depth      = std::max<std::uint64_t>(depth, funcs[g].frame_info().max_depth);
+			}
+			depth += funcs[f].frame_info().frame_size;
+
+			if (bounded[f] && depth <= std::numeric_limits<std::uint32_t>::max()) {
+				funcs[f].frame_info().max_depth = std::uint32_t(depth);
+			} else {
+				bounded[f] = false;
+			}
+
+			marks[f] = Mark::DONE;
+			walk.pop_back();
+		}
 	}
 }
 
@@ -235,15 +464,31 @@ std::shared_ptr<Module> compile(Context& cx, ModuleStorage&& storage) {
 		case SectionCode::FUNC:
 			decode_func_section(cx, *module, decoder, section_size);
 			break;
+		case SectionCode::MEMORY:
+			decode_memory_section(cx, *module, decoder, section_size);
+			break;
+		case SectionCode::GLOBAL:
+			decode_global_section(cx, *module, decoder, section_size);
+			break;
+		case SectionCode::CONST:
+			decode_const_section(cx, *module, decoder, section_size);
+			break;
 		case SectionCode::CODE:
 			decode_code_section(cx, *module, decoder, section_size);
 			break;
+		case SectionCode::DATA:
+			decode_data_section(cx, *module, decoder, section_size);
+			break;
 		default:
 			AB_ASSERT_UNREACHABLE();
 			break;
 		}
 	}
 
+	verify_memory_access(*module);
+
+	analyze_frames(*module);
+
 	return module;
 }
 
@@ -0,0 +1,192 @@
+#include <Ab/Config.hpp>
+#include <Ab/Scheduler.hpp>
+#include <algorithm>
+
+namespace Ab {
+
+Scheduler::Scheduler(VirtualMachine* vm, const SchedulerConfig& config) : vm_(vm), config_(config) {
+	std::size_t count = config.worker_count;
+	if (count == 0) {
+		count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// Every worker must exist before any can steal from it.
+	for (std::size_t i = 0; i < count; ++i) {
+		workers_.push_back(std::make_unique<Worker>());
+	}
+	for (std::size_t i = 0; i < count; ++i) {
+		workers_[i]->thread = std::thread([this, i] { work(i); });
+	}
+}
+
+Scheduler::~Scheduler() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+		++signals_;
+	}
+	wake_.notify_all();
+
+	for (auto& worker : workers_) {
+		worker->thread.join();
+	}
+}
+
+void Scheduler::submit(Task* task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		injected_.push_back(task);
+	}
+	wake_one();
+}
+
+void Scheduler::wake_one() {
+	// Pairs with the fence in WorkStealingDeque::steal. Either a sleeping worker sees the new work
+	// when it rescans before waiting, or we see the sleeper here.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleepers_.load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++signals_;
+	}
+	wake_.notify_one();
+}
+
+void Scheduler::work(std::size_t index) {
+	std::uint32_t seed = std::uint32_t(index) + 1;
+	Worker& self       = *workers_[index];
+
+	while (true) {
+		Task* task = find_task(index, seed);
+		if (task == nullptr) {
+			task = sleep(index, seed);
+			if (task == nullptr) {
+				return;
+			}
+		}
+		if (!self.deque.empty()) {
+			wake_one();
+		}
+		run(task);
+	}
+}
+
+Task* Scheduler::find_task(std::size_t index, std::uint32_t& seed) {
+	if (auto task = workers_[index]->deque.pop()) {
+		return *task;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (Task* task = take_injected(index)) {
+			return task;
+		}
+	}
+
+	return steal(index, seed);
+}
+
+Task* Scheduler::take_injected(std::size_t index) {
+	if (injected_.empty()) {
+		return nullptr;
+	}
+
+	Task* task = injected_.front();
+	injected_.pop_front();
+
+	// Leave the rest of the queue for the other workers.
+	std::size_t share = injected_.size() / workers_.size();
+	for (std::size_t i = 0; i < share; ++i) {
+		workers_[index]->deque.push(injected_.front());
+		injected_.pop_front();
+	}
+
+	return task;
+}
+
+Task* Scheduler::steal(std::size_t index, std::uint32_t& seed) {
+	// xorshift32
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	std::size_t count = workers_.size();
+	for (std::size_t i = 0; i < count; ++i) {
+		std::size_t victim = (seed + i) % count;
+		if (victim == index) {
+			continue;
+		}
+		if (auto task = workers_[victim]->deque.steal()) {
+			return *task;
+		}
+	}
+	return nullptr;
+}
+
+Task* Scheduler::sleep(std::size_t index, std::uint32_t& seed) {
+	std::unique_lock<std::mutex> lock(mutex_);
+	sleepers_.fetch_add(1);
+
+	Task* task = nullptr;
+
+	while (true) {
+		// Rescan, now that any new work will wake us.
+		task = take_injected(index);
+		if (task == nullptr) {
+			task = steal(index, seed);
+		}
+		if (task != nullptr || (stopping_ && pending_.load() == 0)) {
+			break;
+		}
+		std::size_t seen = signals_;
+		wake_.wait(lock, [&] { return signals_ != seen; });
+	}
+
+	sleepers_.fetch_sub(1);
+	return task;
+}
+
+void Scheduler::run(Task* task) {
+	task->set_state(TaskState::RUNNING);
+
+	Context& cx = task->cx_;
+	cx.set_fuel(config_.time_slice);
+
+	Byte* ret = nullptr;
+	if (task->started_) {
+		ret = resume_interpreter(cx);
+	} else {
+		ret            = enter_interpreter(cx, task->func_);
+		task->started_ = true;
+	}
+
+	ExecState& state = cx.exec_state();
+
+	if (state.st_b.condition == ExecCond::SUSPENDED) {
+		task->resume_count_ += 1;
+		task->set_state(TaskState::RUNNABLE);
+		submit(task);
+		return;
+	}
+
+	// The task may be destroyed as soon as it's finished.
+	if (state.st_b.flags.trap) {
+		task->trap_kind_ = clear_trap(&state);
+		task->set_state(TaskState::TRAPPED);
+	} else {
+		task->ret_ = ret;
+		task->set_state(TaskState::DONE);
+	}
+
+	if (pending_.fetch_sub(1) == 1) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stopping_) {
+			++signals_;
+			wake_.notify_all();
+		}
+	}
+}
+
+}  // namespace Ab
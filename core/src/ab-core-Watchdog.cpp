@@ -0,0 +1,73 @@
+#include <Ab/Config.hpp>
+#include <Ab/Watchdog.hpp>
+
+namespace Ab {
+
+Watchdog::Watchdog() : thread_([this] { run(); }) {}
+
+Watchdog::~Watchdog() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	changed_.notify_one();
+	thread_.join();
+}
+
+Watchdog::Ticket Watchdog::arm(Context& cx, Clock::time_point deadline) {
+	bool earliest = false;
+	Ticket ticket = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		ticket = next_ticket_++;
+		earliest = deadlines_.empty() || deadline < deadlines_.begin()->first;
+		deadlines_.emplace(deadline, ticket);
+		armed_.emplace(ticket, std::make_pair(deadline, &cx));
+	}
+	// The watchdog only needs waking when it's sleeping past the new deadline.
+	if (earliest) {
+		changed_.notify_one();
+	}
+	return ticket;
+}
+
+bool Watchdog::disarm(Ticket ticket) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = armed_.find(ticket);
+	if (it == armed_.end()) {
+		// A deadline leaves the armed set when it fires.
+		return true;
+	}
+	deadlines_.erase({it->second.first, ticket});
+	armed_.erase(it);
+	return false;
+}
+
+std::uint64_t Watchdog::fired() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return fired_;
+}
+
+void Watchdog::run() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (!stopping_) {
+		if (deadlines_.empty()) {
+			changed_.wait(lock);
+			continue;
+		}
+
+		auto [deadline, ticket] = *deadlines_.begin();
+		if (Clock::now() < deadline) {
+			changed_.wait_until(lock, deadline);
+			continue;
+		}
+
+		// Fire under the lock, so a disarmed deadline never fires.
+		armed_[ticket].second->interrupt();
+		armed_.erase(ticket);
+		deadlines_.erase(deadlines_.begin());
+		++fired_;
+	}
+}
+
+}  // namespace Ab
@@ -0,0 +1,120 @@
+#include <Ab/BulkMemory.hpp>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+namespace Ab::Test {
+
+constexpr BulkMemoryKernel KERNELS[] = {
+	BulkMemoryKernel::GENERIC,
+	BulkMemoryKernel::SSE2,
+	BulkMemoryKernel::AVX2,
+	BulkMemoryKernel::AVX512,
+};
+
+/// Lengths around the vector widths, and either side of the non-temporal threshold.
+///
+constexpr std::size_t LENGTHS[] = {
+	0, 1, 15, 64, 127, 128, 255, 256, 257, 1000, 4096 + 3, BULK_MEMORY_NON_TEMPORAL_SIZE + 65};
+
+TEST(TestBulkMemory, KernelIsSupported) {
+	EXPECT_TRUE(supports(BulkMemoryKernel::GENERIC));
+	EXPECT_TRUE(supports(bulk_memory_kernel()));
+}
+
+/// Every supported kernel copies like memmove, from and to every alignment, and never writes
+/// outside the destination.
+///
+TEST(TestBulkMemory, Copy) {
+	constexpr std::size_t PAD = 128;
+
+	for (BulkMemoryKernel kernel : KERNELS) {
+		if (!supports(kernel)) {
+			continue;
+		}
+		for (std::size_t n : LENGTHS) {
+			for (std::size_t misalign : {0, 1, 7, 33}) {
+				std::vector<Byte> src(n + PAD);
+				std::vector<Byte> dst(n + 2 * PAD, 0xee);
+				for (std::size_t i = 0; i < src.size(); ++i) {
+					src[i] = Byte(i * 7 + 3);
+				}
+
+				copy_bytes(kernel, dst.data() + PAD + misalign, src.data() + misalign / 2, n);
+
+				EXPECT_EQ(std::memcmp(dst.data() + PAD + misalign, src.data() + misalign / 2, n), 0)
+					<< cstring(kernel) << " n=" << n << " misalign=" << misalign;
+				EXPECT_EQ(dst[PAD + misalign - 1], 0xee);
+				EXPECT_EQ(dst[PAD + misalign + n], 0xee);
+			}
+		}
+	}
+}
+
+/// Overlapping copies, in either direction, have the same result as memmove.
+///
+TEST(TestBulkMemory, OverlappingCopy) {
+	for (BulkMemoryKernel kernel : KERNELS) {
+		if (!supports(kernel)) {
+			continue;
+		}
+		for (std::ptrdiff_t shift : {-65, -1, 1, 65}) {
+			std::vector<Byte> buffer(4096);
+			for (std::size_t i = 0; i < buffer.size(); ++i) {
+				buffer[i] = Byte(i * 13);
+			}
+			std::vector<Byte> expected = buffer;
+
+			std::memmove(expected.data() + 128 + shift, expected.data() + 128, 2048);
+			copy_bytes(kernel, buffer.data() + 128 + shift, buffer.data() + 128, 2048);
+
+			EXPECT_EQ(buffer, expected) << cstring(kernel) << " shift=" << shift;
+		}
+	}
+}
+
+/// Every supported kernel fills like memset, at every alignment, and never writes outside the
+/// destination.
+///
+TEST(TestBulkMemory, Fill) {
+	constexpr std::size_t PAD = 128;
+
+	for (BulkMemoryKernel kernel : KERNELS) {
+		if (!supports(kernel)) {
+			continue;
+		}
+		for (std::size_t n : LENGTHS) {
+			std::vector<Byte> expected(n, 0x5a);
+			for (std::size_t misalign : {0, 1, 7, 33}) {
+				std::vector<Byte> dst(n + 2 * PAD, 0xee);
+
+				fill_bytes(kernel, dst.data() + PAD + misalign, 0x5a, n);
+
+				EXPECT_EQ(std::memcmp(dst.data() + PAD + misalign, expected.data(), n), 0)
+					<< cstring(kernel) << " n=" << n << " misalign=" << misalign;
+				EXPECT_EQ(dst[PAD + misalign - 1], 0xee);
+				EXPECT_EQ(dst[PAD + misalign + n], 0xee);
+			}
+		}
+	}
+}
+
+/// A fill value with the high bit set is splatted to every byte, without sign extension.
+///
+TEST(TestBulkMemory, FillHighByte) {
+	constexpr std::size_t N = 1000;
+
+	for (BulkMemoryKernel kernel : KERNELS) {
+		if (!supports(kernel)) {
+			continue;
+		}
+		std::vector<Byte> expected(N, 0xab);
+		std::vector<Byte> dst(N, 0);
+
+		fill_bytes(kernel, dst.data(), 0xab, N);
+
+		EXPECT_EQ(dst, expected) << cstring(kernel);
+	}
+}
+
+}  // namespace Ab::Test
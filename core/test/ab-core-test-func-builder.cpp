@@ -1,38 +1,46 @@
-#if 0
-
-#include <Ab/XDisasm.hpp>
 #include <Ab/FuncBuilder.hpp>
 #include <Ab/Opcode.hpp>
+#include <Ab/XDisasm.hpp>
 #include <gtest/gtest.h>
 
 namespace Ab::Test {
 
 template <typename T>
-T& interpret(Byte* buffer, std::size_t offset) {
-	return *reinterpret_cast<T*>(buffer + offset);
+T read_at(const ByteBuffer& buffer, std::size_t offset) {
+	return buffer.read<T>(offset);
 }
 
 template <typename T>
-testing::AssertionResult equal_at(Byte* buffer, std::size_t offset, const T& expected) {
-	const auto& value = interpret<const T>(buffer, offset);
+testing::AssertionResult equal_at(const ByteBuffer& buffer, std::size_t offset, const T& expected) {
+	const T value = read_at<T>(buffer, offset);
 
 	testing::Message msg;
-	msg << (void*)buffer << "[" << offset << "]" << "=" << value;
+	msg << "[" << offset << "]"
+	    << "=" << +value;
 
 	if (value == expected) {
 		return testing::AssertionSuccess() << msg;
 	}
-	return testing::AssertionFailure()  << msg;
+	return testing::AssertionFailure() << msg;
 }
 
-#define EXPECT_AT(buffer, offset, value) EXPECT_TRUE(equal_at(buffer, offset, value))
+template <>
+testing::AssertionResult
+equal_at<Opcode>(const ByteBuffer& buffer, std::size_t offset, const Opcode& expected) {
+	const Opcode value = read_at<Opcode>(buffer, offset);
 
-void print_program(FILE* file, const Byte* program, std::size_t nbytes) {
-	for (std::size_t i = 0; i < nbytes; ++i) {
-		fprintf(file, "%p[%lu]=%u\n", program, i, uint(program[i]));
+	testing::Message msg;
+	msg << "[" << offset << "]"
+	    << "=" << value;
+
+	if (value == expected) {
+		return testing::AssertionSuccess() << msg;
 	}
+	return testing::AssertionFailure() << msg;
 }
 
+#define EXPECT_AT(buffer, offset, value) EXPECT_TRUE(equal_at(buffer, offset, value))
+
 TEST(TestFuncBuilder, EmptyFunction) {
 	FuncBuilder fb;
 	fb.emit_nop();
@@ -41,16 +49,57 @@ TEST(TestFuncBuilder, EmptyFunction) {
 	fb.emit_nop();
 	fb.emit_halt();
 
-	auto fn = fb.finalize();
+	auto body = fb.finalize();
+
+	EXPECT_EQ(body.size(), 5);
+	EXPECT_AT(body, 0, Opcode::NOP);
+	EXPECT_AT(body, 1, Opcode::NOP);
+	EXPECT_AT(body, 2, Opcode::NOP);
+	EXPECT_AT(body, 3, Opcode::NOP);
+	EXPECT_AT(body, 4, Opcode::HALT);
+}
+
+TEST(TestFuncBuilder, ImmediateLayout) {
+	FuncBuilder fb;
+	fb.emit_i32_add(1, 2, 3);
+	fb.emit_x64_const(4, 0x0123'4567'89ab'cdef);
+
+	auto body = fb.finalize();
+
+	EXPECT_EQ(body.size(), I32_ADD_SIZEOF + X64_CONST_SIZEOF);
+	EXPECT_AT(body, 0, Opcode::I32_ADD);
+	EXPECT_AT(body, I32_ADD_DST_OFFSET, std::uint8_t(1));
+	EXPECT_AT(body, I32_ADD_LHS_OFFSET, std::uint8_t(2));
+	EXPECT_AT(body, I32_ADD_RHS_OFFSET, std::uint8_t(3));
+	EXPECT_AT(body, I32_ADD_SIZEOF, Opcode::X64_CONST);
+	EXPECT_AT(body, I32_ADD_SIZEOF + X64_CONST_DST_OFFSET, std::uint8_t(4));
+	EXPECT_AT(
+		body, I32_ADD_SIZEOF + X64_CONST_VALUE_OFFSET, std::uint64_t(0x0123'4567'89ab'cdef));
+}
 
-	EXPECT_EQ(fn->header.nparams, 0);
-	EXPECT_EQ(fn->header.nlocals, 0);
+TEST(TestFuncBuilder, RegisterImmediateLayout) {
+	FuncBuilder fb;
+	fb.emit_i32_add_ri(1, 2, -3);
+	fb.emit_f64_mul_rc(4, 5, 6);
+
+	auto body = fb.finalize();
+
+	EXPECT_EQ(body.size(), I32_ADD_RI_SIZEOF + F64_MUL_RC_SIZEOF);
+	EXPECT_AT(body, 0, Opcode::I32_ADD_RI);
+	EXPECT_AT(body, I32_ADD_RI_DST_OFFSET, std::uint8_t(1));
+	EXPECT_AT(body, I32_ADD_RI_LHS_OFFSET, std::uint8_t(2));
+	EXPECT_AT(body, I32_ADD_RI_RHS_OFFSET, std::int32_t(-3));
+	EXPECT_AT(body, I32_ADD_RI_SIZEOF, Opcode::F64_MUL_RC);
+	EXPECT_AT(body, I32_ADD_RI_SIZEOF + F64_MUL_RC_RHS_OFFSET, std::uint32_t(6));
+}
 
-	EXPECT_AT(fn->body, 0, Opcode::NOP);
-	EXPECT_AT(fn->body, 1, Opcode::NOP);
-	EXPECT_AT(fn->body, 2, Opcode::NOP);
-	EXPECT_AT(fn->body, 3, Opcode::NOP);
-	EXPECT_AT(fn->body, 4, Opcode::HALT);
+TEST(TestFuncBuilder, SizeofTableMatchesLayout) {
+	EXPECT_EQ(sizeof_insn(Opcode::NOP), NOP_SIZEOF);
+	EXPECT_EQ(sizeof_insn(Opcode::GOTO_IF), GOTO_IF_SIZEOF);
+	EXPECT_EQ(sizeof_insn(Opcode::F64_CONVERT_U_I64), F64_CONVERT_U_I64_SIZEOF);
+	EXPECT_EQ(sizeof_insn(Opcode(0x03)), 0);
+	EXPECT_EQ(WIDE_OPCODE_SIZEOF_TABLE[RawOpcode(Opcode::NOP)], 0);
+	EXPECT_EQ(WIDE_OPCODE_SIZEOF_TABLE[RawOpcode(Opcode::GOTO_IF)], WIDE_GOTO_IF_SIZEOF);
 }
 
 TEST(TestFuncBuilder, GotoSamePc) {
@@ -58,12 +107,10 @@ TEST(TestFuncBuilder, GotoSamePc) {
 	auto label = fb.place();
 	fb.emit_goto(label);
 
-	auto fn = fb.finalize();
-
-	EXPECT_AT(fn->body, 0, Opcode::GOTO);
-	EXPECT_AT(fn->body, 1, std::int32_t(-5));
+	auto body = fb.finalize();
 
-	delete fn;
+	EXPECT_AT(body, 0, Opcode::GOTO);
+	EXPECT_AT(body, GOTO_OFF_OFFSET, std::int8_t(-GOTO_SIZEOF));
 }
 
 TEST(TestFuncBuilder, GotoForward0) {
@@ -73,13 +120,11 @@ TEST(TestFuncBuilder, GotoForward0) {
 	fb.place(label);
 	fb.emit_nop();
 
-	auto fn = fb.finalize();
+	auto body = fb.finalize();
 
-	EXPECT_AT(fn->body, 0, Opcode::GOTO);
-	EXPECT_AT(fn->body, 1, std::int32_t(0));
-	EXPECT_AT(fn->body, 5, Opcode::NOP);
-
-	delete fn;
+	EXPECT_AT(body, 0, Opcode::GOTO);
+	EXPECT_AT(body, 1, std::int8_t(0));
+	EXPECT_AT(body, 2, Opcode::NOP);
 }
 
 TEST(TestFuncBuilder, ForwardGoto) {
@@ -89,61 +134,112 @@ TEST(TestFuncBuilder, ForwardGoto) {
 	fb.emit_nop();
 	fb.emit_nop();
 	fb.place(label);
-	fb.emit_nop();
-
-	auto fn = fb.finalize();
+	fb.emit_halt();
 
-	EXPECT_AT(fn->body, 0, Opcode::GOTO);
-	EXPECT_AT(fn->body, 1, std::int32_t(2));
-	EXPECT_AT(fn->body, 5, Opcode::NOP);
-	EXPECT_AT(fn->body, 6, Opcode::NOP);
-	EXPECT_AT(fn->body, 7, Opcode::NOP);
+	auto body = fb.finalize();
 
-	delete fn;
+	EXPECT_AT(body, 0, Opcode::GOTO);
+	EXPECT_AT(body, 1, std::int8_t(2));
+	EXPECT_AT(body, 2, Opcode::NOP);
+	EXPECT_AT(body, 3, Opcode::NOP);
+	EXPECT_AT(body, 4, Opcode::HALT);
 }
 
-TEST(TestFuncBuilder, ForwardGoto2) {
+TEST(TestFuncBuilder, BackwardsGoto) {
 	FuncBuilder fb;
-	auto label = fb.make_label();
-	fb.emit_goto(label);
+
+	auto label = fb.place();
 	fb.emit_nop();
 	fb.emit_nop();
 	fb.emit_nop();
+	fb.emit_goto(label);
+
+	auto body = fb.finalize();
+
+	EXPECT_AT(body, 0, Opcode::NOP);
+	EXPECT_AT(body, 1, Opcode::NOP);
+	EXPECT_AT(body, 2, Opcode::NOP);
+	EXPECT_AT(body, 3, Opcode::GOTO);
+	EXPECT_AT(body, 4, std::int8_t(-5));
+}
+
+TEST(TestFuncBuilder, ConditionalGoto) {
+	FuncBuilder fb;
+	auto label = fb.make_label();
+	fb.emit_goto_if(7, label);
+	fb.emit_nop();
 	fb.place(label);
-	fb.emit_halt();
+	fb.emit_goto_unless(8, label);
 
-	auto fn = fb.finalize();
+	auto body = fb.finalize();
 
-	EXPECT_AT(fn->body, 0, Opcode::GOTO);
-	EXPECT_AT(fn->body, 1, std::int32_t(3));
-	EXPECT_AT(fn->body, 5, Opcode::NOP);
-	EXPECT_AT(fn->body, 6, Opcode::NOP);
-	EXPECT_AT(fn->body, 7, Opcode::NOP);
-	EXPECT_AT(fn->body, 8, Opcode::HALT);
+	EXPECT_AT(body, 0, Opcode::GOTO_IF);
+	EXPECT_AT(body, GOTO_IF_TST_OFFSET, std::uint8_t(7));
+	EXPECT_AT(body, GOTO_IF_OFF_OFFSET, std::int8_t(1));
+	EXPECT_AT(body, 4, Opcode::GOTO_UNLESS);
+	EXPECT_AT(body, 4 + GOTO_UNLESS_TST_OFFSET, std::uint8_t(8));
+	EXPECT_AT(body, 4 + GOTO_UNLESS_OFF_OFFSET, std::int8_t(-GOTO_UNLESS_SIZEOF));
+}
 
-	delete fn;
+TEST(TestFuncBuilder, GotoOutOfRange) {
+	FuncBuilder fb;
+	auto label = fb.make_label();
+	fb.emit_goto(label);
+	for (std::size_t i = 0; i < 200; ++i) {
+		fb.emit_nop();
+	}
+	fb.place(label);
+
+	auto body = fb.finalize();
+
+	EXPECT_EQ(body.size(), GOTO_W_SIZEOF + 200);
+	EXPECT_AT(body, 0, Opcode::GOTO_W);
+	EXPECT_AT(body, GOTO_W_OFF_OFFSET, std::int32_t(200));
 }
 
-TEST(TestFuncBuilder, BackwardsGoto) {
+TEST(TestFuncBuilder, RelaxationKeepsShortBranches) {
 	FuncBuilder fb;
+	auto near = fb.make_label();
+	auto far  = fb.make_label();
+	fb.emit_goto_if(1, near);
+	fb.emit_goto_unless(2, far);
+	fb.place(near);
+	for (std::size_t i = 0; i < 200; ++i) {
+		fb.emit_nop();
+	}
+	fb.place(far);
+	fb.emit_goto(near);
 
-	auto label = fb.place();
-	fb.emit_nop();
-	fb.emit_nop();
-	fb.emit_nop();
-	fb.emit_goto(label);
+	auto body = fb.finalize();
 
-	auto fn = fb.finalize();
+	EXPECT_AT(body, 0, Opcode::GOTO_IF);
+	EXPECT_AT(body, GOTO_IF_OFF_OFFSET, std::int8_t(GOTO_UNLESS_W_SIZEOF));
 
-	EXPECT_AT(fn->body, 0, Opcode::NOP);
-	EXPECT_AT(fn->body, 1, Opcode::NOP);
-	EXPECT_AT(fn->body, 2, Opcode::NOP);
-	EXPECT_AT(fn->body, 3, Opcode::GOTO);
-	EXPECT_AT(fn->body, 4, std::int32_t(-8));
+	std::size_t offset = GOTO_IF_SIZEOF;
+	EXPECT_AT(body, offset, Opcode::GOTO_UNLESS_W);
+	EXPECT_AT(body, offset + GOTO_UNLESS_W_TST_OFFSET, std::uint8_t(2));
+	EXPECT_AT(body, offset + GOTO_UNLESS_W_OFF_OFFSET, std::int32_t(200));
 
-	delete fn;
+	offset += GOTO_UNLESS_W_SIZEOF + 200;
+	EXPECT_AT(body, offset, Opcode::GOTO_W);
+	EXPECT_AT(body, offset + GOTO_W_OFF_OFFSET, std::int32_t(-200 - GOTO_W_SIZEOF));
 }
 
-}  // namespace Ab::Test
+TEST(TestFuncBuilder, WideRegisterLayout) {
+	FuncBuilder fb;
+	fb.emit_i32_add(1, 300, 3);
+	fb.emit_i32_add_ri(4, 5, 6);
+
+	auto body = fb.finalize();
+
+	EXPECT_EQ(body.size(), WIDE_I32_ADD_SIZEOF + I32_ADD_RI_SIZEOF);
+	EXPECT_EQ(sizeof_insn({body.data(), body.size()}, 0), WIDE_I32_ADD_SIZEOF);
+	EXPECT_AT(body, 0, Opcode::WIDE);
+	EXPECT_AT(body, 1, Opcode::I32_ADD);
+	EXPECT_AT(body, WIDE_I32_ADD_DST_OFFSET, std::uint16_t(1));
+	EXPECT_AT(body, WIDE_I32_ADD_LHS_OFFSET, std::uint16_t(300));
+	EXPECT_AT(body, WIDE_I32_ADD_RHS_OFFSET, std::uint16_t(3));
+	EXPECT_AT(body, WIDE_I32_ADD_SIZEOF, Opcode::I32_ADD_RI);
+}
 
-#endif // 0
+}  // namespace Ab::Test
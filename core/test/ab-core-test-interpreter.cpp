@@ -6,8 +6,14 @@
 #include <Ab/ModuleWriter.hpp>
 #include <Ab/Test/BasicTest.hpp>
 #include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/Threading.hpp>
 #include <Ab/VirtualMachine.hpp>
+#include <Ab/Watchdog.hpp>
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
 
 namespace Ab::Test {
 
@@ -228,6 +234,1681 @@ TEST_F(TestInterpreter, I32AddFunc) {
 			cx, inst->func_inst(0), std::int32_t(33), std::int32_t(44)),
 		std::make_tuple(77));
 }
+/// Instantiate a module with a single function, with a body generated by a FuncBuilder.
+///
+template <typename F>
+ModuleInst* instantiate_func(Context& cx, FuncType type, std::uint32_t nregs, F&& build,
+	Dispatch dispatch = DEFAULT_DISPATCH) {
+	ModuleNode mod;
+	push(mod.types, std::move(type));
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = nregs;
+
+	FuncBuilder fb;
+	build(fb);
+	func.push<BytecodeInsnNode>(fb.finalize());
+
+	return instantiate(cx, mod.write(), dispatch);
+}
+
+/// Call the function, and return the kind of trap it raised.
+///
+template <typename... Rs, typename... As>
+TrapKind trap_of(Context& cx, FuncInst* func, As... as) {
+	try {
+		static_call<Rs...>(cx, func, as...);
+	} catch (const TrapError& e) {
+		return e.kind();
+	}
+	return TrapKind::NONE;
+}
+
+TEST_F(TestInterpreter, I32DivS) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			fb.emit_i32_div_s(2, 0, 1);
+			fb.emit_x32_return(2);
+		});
+	auto func = inst->func_inst(0);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 7, 2), std::make_tuple(3));
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, -7, 2), std::make_tuple(-3));
+	EXPECT_EQ(trap_of<std::int32_t>(cx, func, 7, 0), TrapKind::INTEGER_DIVIDE_BY_ZERO);
+	EXPECT_EQ(
+		trap_of<std::int32_t>(cx, func, std::numeric_limits<std::int32_t>::min(), -1),
+		TrapKind::INTEGER_OVERFLOW);
+
+	// The interpreter is still usable after a trap.
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 9, 3), std::make_tuple(3));
+}
+
+TEST_F(TestInterpreter, I32RemSOfMinByMinusOne) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			fb.emit_i32_rem_s(2, 0, 1);
+			fb.emit_x32_return(2);
+		});
+
+	EXPECT_EQ(
+		static_call<std::int32_t>(
+			cx, inst->func_inst(0), std::numeric_limits<std::int32_t>::min(), -1),
+		std::make_tuple(0));
+}
+
+TEST_F(TestInterpreter, I32ShlWrapsShiftCount) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			fb.emit_i32_shl(2, 0, 1);
+			fb.emit_x32_return(2);
+		});
+	auto func = inst->func_inst(0);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 4, 2), std::make_tuple(16));
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 4, 32), std::make_tuple(4));
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 4, 33), std::make_tuple(8));
+}
+
+TEST_F(TestInterpreter, I32LtS) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			fb.emit_i32_lt_s(2, 0, 1);
+			fb.emit_x32_return(2);
+		});
+	auto func = inst->func_inst(0);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, -1, 1), std::make_tuple(1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 1, -1), std::make_tuple(0));
+}
+
+TEST_F(TestInterpreter, I64Mul) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I64, ValType::I64}, {ValType::I64}), 2, [](FuncBuilder& fb) {
+			fb.emit_i64_mul(4, 0, 2);
+			fb.emit_x64_return(4);
+		});
+
+	EXPECT_EQ(
+		static_call<std::int64_t>(
+			cx, inst->func_inst(0), std::int64_t(1) << 40, std::int64_t(-3)),
+		std::make_tuple(-(std::int64_t(3) << 40)));
+}
+
+TEST_F(TestInterpreter, F64Add) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::F64, ValType::F64}, {ValType::F64}), 2, [](FuncBuilder& fb) {
+			fb.emit_f64_add(4, 0, 2);
+			fb.emit_x64_return(4);
+		});
+
+	EXPECT_EQ(static_call<double>(cx, inst->func_inst(0), 1.5, 2.25), std::make_tuple(3.75));
+}
+
+TEST_F(TestInterpreter, F32MinOrdersNegativeZero) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::F32, ValType::F32}, {ValType::F32}), 1, [](FuncBuilder& fb) {
+			fb.emit_f32_min(2, 0, 1);
+			fb.emit_x32_return(2);
+		});
+	auto func = inst->func_inst(0);
+
+	auto [zero] = static_call<float>(cx, func, 0.0f, -0.0f);
+	EXPECT_TRUE(std::signbit(zero));
+
+	auto [nan] = static_call<float>(cx, func, 1.0f, std::numeric_limits<float>::quiet_NaN());
+	EXPECT_TRUE(std::isnan(nan));
+}
+
+TEST_F(TestInterpreter, I32TruncSF64) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::F64}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			fb.emit_i32_trunc_s_f64(2, 0);
+			fb.emit_x32_return(2);
+		});
+	auto func = inst->func_inst(0);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, -3.9), std::make_tuple(-3));
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, -2147483648.9), std::make_tuple(INT32_MIN));
+	EXPECT_EQ(
+		trap_of<std::int32_t>(cx, func, std::numeric_limits<double>::quiet_NaN()),
+		TrapKind::INVALID_CONVERSION);
+	EXPECT_EQ(trap_of<std::int32_t>(cx, func, 2147483648.0), TrapKind::INTEGER_OVERFLOW);
+}
+
+TEST_F(TestInterpreter, I64ExtendUI32) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I64}), 2, [](FuncBuilder& fb) {
+			fb.emit_i64_extend_u_i32(1, 0);
+			fb.emit_x64_return(1);
+		});
+
+	EXPECT_EQ(
+		static_call<std::int64_t>(cx, inst->func_inst(0), -1),
+		std::make_tuple(std::int64_t(0xffff'ffff)));
+}
+
+/// Sum the integers from n down to 1 with a loop.
+///
+TEST_F(TestInterpreter, SumLoop) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I32}), 2, [](FuncBuilder& fb) {
+			auto loop = fb.make_label();
+			auto done = fb.make_label();
+			fb.emit_x32_const(1, 0);
+			fb.emit_x32_const(2, 1);
+			fb.place(loop);
+			fb.emit_goto_unless(0, done);
+			fb.emit_i32_add(1, 1, 0);
+			fb.emit_i32_sub(0, 0, 2);
+			fb.emit_goto(loop);
+			fb.place(done);
+			fb.emit_x32_return(1);
+		});
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 10), std::make_tuple(55));
+}
+
+/// The same loop, with the counter updated by register-immediate instructions.
+///
+TEST_F(TestInterpreter, SumLoopRegisterImmediate) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I32}), 2, [](FuncBuilder& fb) {
+			auto loop = fb.make_label();
+			auto done = fb.make_label();
+			fb.emit_x32_const(1, 0);
+			fb.place(loop);
+			fb.emit_i32_gt_s_ri(2, 0, 0);
+			fb.emit_goto_unless(2, done);
+			fb.emit_i32_add(1, 1, 0);
+			fb.emit_i32_sub_ri(0, 0, 1);
+			fb.emit_goto(loop);
+			fb.place(done);
+			fb.emit_x32_return(1);
+		});
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 10), std::make_tuple(55));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), -4), std::make_tuple(0));
+}
+
+/// The sum loop, with it's registers past 0xff, and a loop body too large for short branches.
+///
+TEST_F(TestInterpreter, WideRegistersAndLongBranches) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		auto inst = instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 320,
+			[](FuncBuilder& fb) {
+				auto loop = fb.make_label();
+				auto done = fb.make_label();
+				fb.emit_x32_const(300, 0);
+				fb.emit_x32_const(301, 1);
+				fb.place(loop);
+				fb.emit_goto_unless(0, done);
+				fb.emit_i32_add(300, 300, 0);
+				for (std::size_t i = 0; i < 200; ++i) {
+					fb.emit_nop();
+				}
+				fb.emit_i32_sub(0, 0, 301);
+				fb.emit_goto(loop);
+				fb.place(done);
+				fb.emit_x32_return(300);
+			},
+			dispatch);
+
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 10), std::make_tuple(55));
+	}
+}
+
+TEST_F(TestInterpreter, I64RegisterImmediate) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I64}, {ValType::I64}), 0, [](FuncBuilder& fb) {
+			fb.emit_i64_shl_ri(0, 0, 68);
+			fb.emit_i64_add_ri(0, 0, std::int64_t(1) << 40);
+			fb.emit_x64_return(0);
+		});
+
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst->func_inst(0), std::int64_t(3)),
+		std::make_tuple((std::int64_t(1) << 40) + 48));
+}
+
+/// Float register-constant instructions read the right hand side from the module's constants.
+///
+TEST_F(TestInterpreter, FloatRegisterConstant) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::F64}, {ValType::F64}));
+	push(mod.types, FuncType({ValType::F32}, {ValType::F32}));
+	mod.f32_consts = {0.5f, 4.0f};
+	mod.f64_consts = {1.25, 3.0};
+
+	FuncNode& f64_func = push(mod.funcs);
+	f64_func.type_idx  = 0;
+	f64_func.nregs     = 0;
+	f64_func.push<F64AddRcInsnNode>(0, 0, 1);
+	{
+		FuncBuilder fb;
+		fb.emit_f64_mul_rc(0, 0, 0);
+		fb.emit_x64_return(0);
+		f64_func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& f32_func = push(mod.funcs);
+	f32_func.type_idx  = 1;
+	f32_func.nregs     = 0;
+	f32_func.push<F32AddRcInsnNode>(0, 0, 0);
+	{
+		FuncBuilder fb;
+		fb.emit_f32_div_rc(0, 0, 1);
+		fb.emit_x32_return(0);
+		f32_func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_EQ(static_call<double>(cx, inst->func_inst(0), 1.0), std::make_tuple(5.0));
+	EXPECT_EQ(static_call<float>(cx, inst->func_inst(1), 7.5f), std::make_tuple(2.0f));
+}
+
+/// A constant index past the end of it's table is rejected when the body is threaded.
+///
+TEST_F(TestInterpreter, ThreadingRejectsInvalidConstant) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(
+		instantiate_func(
+			cx, FuncType({ValType::F64}, {ValType::F64}), 0,
+			[](FuncBuilder& fb) {
+				fb.emit_f64_add_rc(0, 0, 0);
+				fb.emit_x64_return(0);
+			}),
+		ThreadingError);
+}
+
+TEST_F(TestInterpreter, UnreachableTraps) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(cx, FuncType({}, {}), 0, [](FuncBuilder& fb) {
+		fb.emit_unreachable();
+	});
+
+	EXPECT_EQ(trap_of<>(cx, inst->func_inst(0)), TrapKind::UNREACHABLE);
+}
+
+/// Recursive fibonacci, calling itself through the interpreter.
+///
+TEST_F(TestInterpreter, RecursiveFib) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 4;
+
+	FuncBuilder fb;
+	auto recurse = fb.make_label();
+	fb.emit_x32_const(1, 2);
+	fb.emit_i32_lt_s(2, 0, 1);
+	fb.emit_goto_unless(2, recurse);
+	fb.emit_x32_return(0);
+	fb.place(recurse);
+	fb.emit_x32_const(1, 1);
+	fb.emit_i32_sub(4, 0, 1);
+	fb.emit_call(0, 4);
+	fb.emit_load_result_x32(3);
+	fb.emit_x32_const(1, 2);
+	fb.emit_i32_sub(4, 0, 1);
+	fb.emit_call(0, 4);
+	fb.emit_load_result_x32(4);
+	fb.emit_i32_add(3, 3, 4);
+	fb.emit_x32_return(3);
+	func.push<BytecodeInsnNode>(fb.finalize());
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 1), std::make_tuple(1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 10), std::make_tuple(55));
+}
+
+/// Call a 64-bit accessor, and a void function, from the interpreter.
+///
+TEST_F(TestInterpreter, CallAndReturnValues) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I64}, {ValType::I64}));
+	push(mod.types, FuncType({ValType::I64}, {ValType::I64}));
+	push(mod.types, FuncType({}, {}));
+
+	FuncNode& caller = push(mod.funcs);
+	caller.type_idx  = 0;
+	caller.nregs     = 2;
+	{
+		FuncBuilder fb;
+		fb.emit_call(2, 0);
+		fb.emit_call(1, 0);
+		fb.emit_load_result_x64(2);
+		fb.emit_i64_add(2, 2, 0);
+		fb.emit_x64_return(2);
+		caller.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& doubler = push(mod.funcs);
+	doubler.type_idx  = 1;
+	doubler.nregs     = 0;
+	{
+		FuncBuilder fb;
+		fb.emit_i64_add(0, 0, 0);
+		fb.emit_x64_return(0);
+		doubler.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& nothing = push(mod.funcs);
+	nothing.type_idx  = 2;
+	nothing.nregs     = 0;
+	nothing.push<ReturnInsnNode>();
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_EQ(
+		static_call<std::int64_t>(cx, inst->func_inst(0), std::int64_t(1) << 33),
+		std::make_tuple(std::int64_t(3) << 33));
+
+	// Every function of the instance shares one constant pool.
+	EXPECT_EQ(&inst->func_inst(0)->const_pool(), &inst->func_inst(1)->const_pool());
+	EXPECT_EQ(&inst->func_inst(0)->const_pool(), &inst->func_inst(2)->const_pool());
+}
+
+/// A trap in a callee unwinds every interpreter frame back to the native caller.
+///
+TEST_F(TestInterpreter, TrapInCallee) {
+	ModuleNode mod;
+	push(mod.types, FuncType({}, {}));
+
+	FuncNode& caller = push(mod.funcs);
+	caller.type_idx  = 0;
+	caller.nregs     = 0;
+	{
+		FuncBuilder fb;
+		fb.emit_call(1, 0);
+		fb.emit_return();
+		caller.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& callee = push(mod.funcs);
+	callee.type_idx  = 0;
+	callee.nregs     = 0;
+	callee.push<UnreachableInsnNode>();
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	Byte* sp = cx.exec_state().st_a.sp;
+	EXPECT_EQ(trap_of<>(cx, inst->func_inst(0)), TrapKind::UNREACHABLE);
+	EXPECT_EQ(cx.exec_state().st_a.sp, sp);
+}
+
+/// Unbounded recursion traps, rather than running off the end of the stack.
+///
+TEST_F(TestInterpreter, StackOverflow) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(cx, FuncType({}, {}), 0, [](FuncBuilder& fb) {
+		fb.emit_call(0, 0);
+		fb.emit_return();
+	});
+
+	EXPECT_EQ(trap_of<>(cx, inst->func_inst(0)), TrapKind::STACK_OVERFLOW);
+}
+
+/// A stack backed by huge pages is aligned to a huge page, and still overflows into it's guard.
+///
+TEST_F(TestInterpreter, HugePageStack) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm, ContextConfig{StackConfig{mebibytes(3), HugePages::TRANSPARENT}});
+
+	const Stack& stack = cx.interpreter().stack();
+	EXPECT_EQ(stack.size(), Page::round_to_huge(mebibytes(3)));
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(stack.begin()) % Page::huge_size(), 0);
+	EXPECT_LE(stack.huge_resident_size(), stack.size());
+
+	auto inst = instantiate_func(cx, FuncType({}, {}), 0, [](FuncBuilder& fb) {
+		fb.emit_call(0, 0);
+		fb.emit_return();
+	});
+
+	EXPECT_EQ(trap_of<>(cx, inst->func_inst(0)), TrapKind::STACK_OVERFLOW);
+	EXPECT_EQ(inst->threaded_code().huge_resident_size(), 0);
+}
+
+/// A context created under a NUMA policy places it's instances' memory on it's node. Binding may
+/// fail without NUMA support in the kernel, which leaves the memory usable.
+///
+TEST_F(TestInterpreter, NumaPlacement) {
+	VirtualMachine vm(runtime());
+	ContextConfig config;
+	config.numa_policy = NumaPolicy::PREFERRED;
+	Context cx(&vm, config);
+
+	EXPECT_EQ(cx.numa_policy(), NumaPolicy::PREFERRED);
+	EXPECT_LT(cx.numa_node(), Process::properties().numa_node_count());
+
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 1});
+
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 1;
+	{
+		FuncBuilder fb;
+		fb.emit_i32_store(0, 0, 0);
+		fb.emit_i32_load(1, 0, 0);
+		fb.emit_x32_return(1);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	std::unique_ptr<ModuleInst> inst(instantiate(cx, mod.write()));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 1234), std::make_tuple(1234));
+}
+
+/// Leaf functions, and functions only calling into non-recursive functions, have a bounded stack.
+///
+TEST_F(TestInterpreter, FrameAnalysis) {
+	ModuleNode mod;
+	push(mod.types, FuncType({}, {}));
+
+	auto push_func = [&](std::uint32_t nregs, auto&& build) {
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = nregs;
+		FuncBuilder fb;
+		build(fb);
+		fb.emit_return();
+		func.push<BytecodeInsnNode>(fb.finalize());
+	};
+
+	push_func(2, [](FuncBuilder&) {});
+	push_func(4, [](FuncBuilder& fb) { fb.emit_call(0, 0); });
+	push_func(0, [](FuncBuilder& fb) { fb.emit_call(3, 0); });
+	push_func(0, [](FuncBuilder& fb) { fb.emit_call(2, 0); });
+	push_func(1, [](FuncBuilder& fb) { fb.emit_call_indirect(0, 0, 0); });
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	auto info = [&](std::size_t i) { return inst->func_inst(i)->base()->frame_info(); };
+
+	EXPECT_EQ(info(0).frame_size, sizeof(NormalFrame) + 2 * SIZEOF_SLOT);
+	EXPECT_EQ(info(0).max_depth, info(0).frame_size);
+
+	EXPECT_EQ(info(1).max_depth, info(1).frame_size + info(0).frame_size);
+
+	EXPECT_EQ(info(2).max_depth, 0);
+	EXPECT_EQ(info(3).max_depth, 0);
+	EXPECT_EQ(info(4).max_depth, 0);
+	EXPECT_EQ(inst->func_inst(4)->stack_reserve(), info(4).frame_size);
+}
+
+/// A call chain with a bounded depth is checked before it is entered. Each frame here is close to
+/// the largest possible, and together they are deeper than the stack.
+///
+TEST_F(TestInterpreter, BoundedDepthCheckedAtEntry) {
+	constexpr std::size_t NFUNCS = 40;
+
+	ModuleNode mod;
+	push(mod.types, FuncType({}, {}));
+
+	for (std::size_t i = 0; i < NFUNCS; ++i) {
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = 60000;
+		FuncBuilder fb;
+		if (i + 1 < NFUNCS) {
+			fb.emit_call(i + 1, 0);
+		}
+		fb.emit_return();
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_GT(inst->func_inst(0)->stack_reserve(), Stack::DEFAULT_SIZE);
+
+	Byte* sp = cx.exec_state().st_a.sp;
+	EXPECT_EQ(trap_of<>(cx, inst->func_inst(0)), TrapKind::STACK_OVERFLOW);
+	EXPECT_EQ(cx.exec_state().st_a.sp, sp);
+	EXPECT_EQ(trap_of<>(cx, inst->func_inst(NFUNCS / 2)), TrapKind::NONE);
+}
+
+/// Recursion tens of thousands of calls deep fits in the stack.
+///
+TEST_F(TestInterpreter, DeepRecursion) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I32}), 2, [](FuncBuilder& fb) {
+			auto recurse = fb.make_label();
+			fb.emit_goto_if(0, recurse);
+			fb.emit_x32_return(0);
+			fb.place(recurse);
+			fb.emit_i32_sub_ri(1, 0, 1);
+			fb.emit_call(0, 1);
+			fb.emit_load_result_x32(2);
+			fb.emit_i32_add(2, 2, 0);
+			fb.emit_x32_return(2);
+		});
+
+	EXPECT_EQ(
+		static_call<std::int32_t>(cx, inst->func_inst(0), 50000), std::make_tuple(1250025000));
+}
+
+/// Call a function, refueling and resuming it every time it runs out of fuel. Returns the result,
+/// and the number of times execution yielded.
+///
+std::pair<std::int32_t, int> call_with_fuel(
+	Context& cx, FuncInst* func, std::int32_t arg, std::int64_t fuel) {
+	Byte* reg_ptr = enter_native_frame(cx, func->nregs());
+	set_stack_elements<std::int32_t>(reg_ptr, arg);
+
+	cx.set_fuel(fuel);
+	Byte* ret_ptr = enter_interpreter(cx, func);
+	int yields    = 0;
+	while (cx.exec_state().st_b.condition == ExecCond::SUSPENDED) {
+		EXPECT_EQ(cx.fuel(), 0);
+		yields += 1;
+		cx.set_fuel(fuel);
+		ret_ptr = resume_interpreter(cx);
+	}
+
+	auto [result] = get_stack_elements<std::int32_t>(ret_ptr);
+	leave_native_frame(cx, func->nregs());
+	cx.set_fuel(UNLIMITED_FUEL);
+	return {result, yields};
+}
+
+/// Backward branches consume fuel. Execution yields when it runs out, and resumes at the branch
+/// target.
+///
+TEST_F(TestInterpreter, FuelYieldsAtBackwardBranch) {
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		auto inst = instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 1,
+			[](FuncBuilder& fb) {
+				auto loop = fb.make_label();
+				auto body = fb.make_label();
+				fb.emit_x32_const(1, 0);
+				fb.place(loop);
+				fb.emit_goto_if(0, body);
+				fb.emit_x32_return(1);
+				fb.place(body);
+				fb.emit_i32_add(1, 1, 0);
+				fb.emit_i32_sub_ri(0, 0, 1);
+				fb.emit_goto(loop);
+			},
+			dispatch);
+
+		EXPECT_EQ(call_with_fuel(cx, inst->func_inst(0), 30, 3), std::make_pair(465, 10));
+		EXPECT_EQ(
+			call_with_fuel(cx, inst->func_inst(0), 30, UNLIMITED_FUEL), std::make_pair(465, 0));
+	}
+}
+
+/// Call entries consume fuel. Execution yields in the callee, and resumes at it's entry.
+///
+TEST_F(TestInterpreter, FuelYieldsAtCallEntry) {
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		auto inst = instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 2,
+			[](FuncBuilder& fb) {
+				auto recurse = fb.make_label();
+				fb.emit_goto_if(0, recurse);
+				fb.emit_x32_return(0);
+				fb.place(recurse);
+				fb.emit_i32_sub_ri(1, 0, 1);
+				fb.emit_call(0, 1);
+				fb.emit_load_result_x32(2);
+				fb.emit_i32_add(2, 2, 0);
+				fb.emit_x32_return(2);
+			},
+			dispatch);
+
+		EXPECT_EQ(call_with_fuel(cx, inst->func_inst(0), 5, 1), std::make_pair(15, 5));
+		EXPECT_EQ(call_with_fuel(cx, inst->func_inst(0), 100, 7), std::make_pair(5050, 14));
+	}
+}
+
+/// A static call which runs out of fuel throws, and leaves the context usable.
+///
+TEST_F(TestInterpreter, StaticCallOutOfFuelThrows) {
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		auto inst = instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 1,
+			[](FuncBuilder& fb) {
+				auto loop = fb.make_label();
+				auto body = fb.make_label();
+				fb.emit_x32_const(1, 0);
+				fb.place(loop);
+				fb.emit_goto_if(0, body);
+				fb.emit_x32_return(1);
+				fb.place(body);
+				fb.emit_i32_add(1, 1, 0);
+				fb.emit_i32_sub_ri(0, 0, 1);
+				fb.emit_goto(loop);
+			},
+			dispatch);
+		Byte* sp = cx.exec_state().st_a.sp;
+
+		cx.set_fuel(3);
+		EXPECT_THROW(static_call<std::int32_t>(cx, inst->func_inst(0), 30), SuspendedError);
+		EXPECT_EQ(cx.exec_state().st_a.sp, sp);
+		EXPECT_EQ(cx.exec_state().st_b.condition, ExecCond::HALTED);
+
+		cx.set_fuel(UNLIMITED_FUEL);
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 30), std::make_tuple(465));
+	}
+}
+
+/// Build a function which spins forever when it's argument is nonzero, and otherwise returns 7.
+///
+ModuleInst* instantiate_spin(Context& cx, Dispatch dispatch) {
+	return instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I32}), 1,
+		[](FuncBuilder& fb) {
+			auto loop = fb.make_label();
+			fb.place(loop);
+			fb.emit_goto_if(0, loop);
+			fb.emit_x32_const(1, 7);
+			fb.emit_x32_return(1);
+		},
+		dispatch);
+}
+
+/// Another thread can stop an infinite loop. The call traps, and the context is usable after.
+///
+TEST_F(TestInterpreter, InterruptStopsInfiniteLoop) {
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		auto inst = instantiate_spin(cx, dispatch);
+		Byte* sp  = cx.exec_state().st_a.sp;
+
+		std::thread interrupter([&] {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			cx.interrupt();
+		});
+		EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(0), 1), TrapKind::INTERRUPTED);
+		interrupter.join();
+
+		EXPECT_EQ(cx.exec_state().st_a.sp, sp);
+		EXPECT_EQ(cx.exec_state().st_b.condition, ExecCond::HALTED);
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 0), std::make_tuple(7));
+	}
+}
+
+/// A watchdog deadline interrupts a call which runs too long, and leaves calls which finish
+/// in time alone.
+///
+TEST_F(TestInterpreter, WatchdogDeadline) {
+	Watchdog watchdog;
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_spin(cx, DEFAULT_DISPATCH);
+
+	{
+		Deadline deadline(watchdog, cx, std::chrono::milliseconds(10));
+		EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(0), 1), TrapKind::INTERRUPTED);
+	}
+	EXPECT_EQ(watchdog.fired(), 1u);
+
+	{
+		Deadline deadline(watchdog, cx, std::chrono::seconds(60));
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 0), std::make_tuple(7));
+	}
+	EXPECT_EQ(watchdog.fired(), 1u);
+}
+
+/// A deadline which did not fire leaves an interrupt from elsewhere pending.
+///
+TEST_F(TestInterpreter, DeadlineKeepsExternalInterrupt) {
+	Watchdog watchdog;
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_spin(cx, DEFAULT_DISPATCH);
+
+	{
+		Deadline deadline(watchdog, cx, std::chrono::seconds(60));
+		cx.interrupt();
+	}
+	EXPECT_EQ(watchdog.fired(), 0u);
+	EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(0), 1), TrapKind::INTERRUPTED);
+}
+
+/// The handler of a threaded instruction.
+///
+const void* handler_at(const FuncInst* func, std::size_t offset) {
+	return *reinterpret_cast<const void* const*>(func->body() + offset);
+}
+
+/// Adjacent instructions are fused into superinstructions when they are threaded. The bytecode is
+/// left as it was.
+///
+TEST_F(TestInterpreter, ThreaderFusesSuperinstructions) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			fb.emit_i32_add(2, 0, 1);
+			fb.emit_x32_return(2);
+		});
+	auto func                   = inst->func_inst(0);
+	const void* const* handlers = handler_table(func->dispatch());
+
+	EXPECT_EQ(Opcode(func->base()->body()[0]), Opcode::I32_ADD);
+	EXPECT_EQ(Opcode(func->base()->body()[I32_ADD_SIZEOF]), Opcode::X32_RETURN);
+	EXPECT_EQ(handler_at(func, 0), handlers[RawOpcode(fuse(Opcode::I32_ADD, Opcode::X32_RETURN))]);
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 20, 22), std::make_tuple(42));
+}
+
+/// A superinstruction in bytecode must be followed by it's second operator, whose handler it jumps
+/// into. Without it, the handler would decode whatever follows with the wrong layout.
+///
+TEST_F(TestInterpreter, ThreadingRejectsBrokenSuperinstruction) {
+	constexpr Opcode SOP = fuse(Opcode::I32_LT_S, Opcode::GOTO_UNLESS);
+	if constexpr (SOP == Opcode::I32_LT_S) {
+		return;  // No such superinstruction in this build.
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	// Instantiate a body, with it's first instruction replaced by the superinstruction.
+	auto instantiate_fused = [&](auto&& build) {
+		ModuleNode mod;
+		push(mod.types, FuncType({ValType::I32, ValType::I32}, {ValType::I32}));
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = 1;
+
+		FuncBuilder fb;
+		build(fb);
+		ByteBuffer bytes = fb.finalize();
+		bytes.write(0, SOP);
+		func.push<BytecodeInsnNode>(std::move(bytes));
+
+		return instantiate(cx, mod.write());
+	};
+
+	EXPECT_THROW(
+		instantiate_fused([](FuncBuilder& fb) {
+			fb.emit_i32_lt_s(2, 0, 1);
+			fb.emit_i32_add(2, 0, 1);
+			fb.emit_x32_return(2);
+		}),
+		ThreadingError);
+
+	EXPECT_THROW(
+		instantiate_fused([](FuncBuilder& fb) { fb.emit_i32_lt_s(2, 0, 1); }), ThreadingError);
+
+	auto inst = instantiate_fused([](FuncBuilder& fb) {
+		auto other = fb.make_label();
+		fb.emit_i32_lt_s(2, 0, 1);
+		fb.emit_goto_unless(2, other);
+		fb.emit_x32_return(0);
+		fb.place(other);
+		fb.emit_x32_return(1);
+	});
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 1, 2), std::make_tuple(1));
+}
+
+/// A superinstruction ending in a branch still reaches both targets.
+///
+TEST_F(TestInterpreter, FusedCompareAndBranch) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto inst = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1, [](FuncBuilder& fb) {
+			auto other = fb.make_label();
+			fb.emit_i32_lt_s(2, 0, 1);
+			fb.emit_goto_unless(2, other);
+			fb.emit_x32_return(0);
+			fb.place(other);
+			fb.emit_x32_return(1);
+		});
+	auto func = inst->func_inst(0);
+
+	EXPECT_EQ(handler_at(func, 0),
+		handler_table(func->dispatch())[RawOpcode(fuse(Opcode::I32_LT_S, Opcode::GOTO_UNLESS))]);
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 1, 2), std::make_tuple(1));
+	EXPECT_EQ(static_call<std::int32_t>(cx, func, 3, 2), std::make_tuple(2));
+}
+
+/// The tail-call interpreter runs loops, superinstructions and traps like the computed-goto one.
+///
+TEST_F(TestInterpreter, TailCallDispatch) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	auto sum = instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I32}), 2,
+		[](FuncBuilder& fb) {
+			auto loop = fb.make_label();
+			auto done = fb.make_label();
+			fb.emit_x32_const(1, 0);
+			fb.emit_x32_const(2, 1);
+			fb.place(loop);
+			fb.emit_goto_unless(0, done);
+			fb.emit_i32_add(1, 1, 0);
+			fb.emit_i32_sub(0, 0, 2);
+			fb.emit_goto(loop);
+			fb.place(done);
+			fb.emit_x32_return(1);
+		},
+		Dispatch::TAIL_CALL);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, sum->func_inst(0), 100), std::make_tuple(5050));
+
+	auto div = instantiate_func(
+		cx, FuncType({ValType::I32, ValType::I32}, {ValType::I32}), 1,
+		[](FuncBuilder& fb) {
+			fb.emit_i32_div_s(2, 0, 1);
+			fb.emit_x32_return(2);
+		},
+		Dispatch::TAIL_CALL);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, div->func_inst(0), 7, 2), std::make_tuple(3));
+	EXPECT_EQ(
+		trap_of<std::int32_t>(cx, div->func_inst(0), 7, 0), TrapKind::INTEGER_DIVIDE_BY_ZERO);
+}
+
+/// The tail-call interpreter calls, returns and overflows the stack like the computed-goto one.
+///
+TEST_F(TestInterpreter, TailCallDispatchCalls) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	auto fib = instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I32}), 4,
+		[](FuncBuilder& fb) {
+			auto recurse = fb.make_label();
+			fb.emit_x32_const(1, 2);
+			fb.emit_i32_lt_s(2, 0, 1);
+			fb.emit_goto_unless(2, recurse);
+			fb.emit_x32_return(0);
+			fb.place(recurse);
+			fb.emit_x32_const(1, 1);
+			fb.emit_i32_sub(4, 0, 1);
+			fb.emit_call(0, 4);
+			fb.emit_load_result_x32(3);
+			fb.emit_x32_const(1, 2);
+			fb.emit_i32_sub(4, 0, 1);
+			fb.emit_call(0, 4);
+			fb.emit_load_result_x32(4);
+			fb.emit_i32_add(3, 3, 4);
+			fb.emit_x32_return(3);
+		},
+		Dispatch::TAIL_CALL);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, fib->func_inst(0), 15), std::make_tuple(610));
+
+	auto forever = instantiate_func(
+		cx, FuncType({}, {}), 0,
+		[](FuncBuilder& fb) {
+			fb.emit_call(0, 0);
+			fb.emit_return();
+		},
+		Dispatch::TAIL_CALL);
+
+	EXPECT_EQ(trap_of<>(cx, forever->func_inst(0)), TrapKind::STACK_OVERFLOW);
+}
+
+/// Function bodies are threaded at instantiation: every instruction begins with it's handler.
+///
+TEST_F(TestInterpreter, ThreadedCodeLayout) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		auto inst = instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 1,
+			[](FuncBuilder& fb) {
+				fb.emit_nop();
+				fb.emit_x32_return(0);
+			},
+			dispatch);
+		auto func = inst->func_inst(0);
+
+		const void* const* handlers = handler_table(dispatch);
+		const Byte* body            = func->body();
+
+		EXPECT_EQ(func->dispatch(), dispatch);
+		EXPECT_EQ(*reinterpret_cast<const void* const*>(body), handlers[RawOpcode(Opcode::NOP)]);
+		EXPECT_EQ(
+			*reinterpret_cast<const void* const*>(body + Threaded::NOP_SIZEOF),
+			handlers[RawOpcode(Opcode::X32_RETURN)]);
+		EXPECT_EQ(body[Threaded::NOP_SIZEOF + Threaded::X32_RETURN_SRC_OFFSET], 0);
+		EXPECT_EQ(static_call<std::int32_t>(cx, func, 42), std::make_tuple(42));
+	}
+}
+
+/// A branch into the middle of an instruction is rejected when the body is threaded.
+///
+TEST_F(TestInterpreter, ThreadingRejectsInvalidBranch) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(
+		instantiate_func(
+			cx, FuncType({}, {}), 0,
+			[](FuncBuilder& fb) {
+				auto label = fb.make_label(1);
+				fb.emit_x32_const(0, 0);
+				fb.emit_goto(label);
+			}),
+		ThreadingError);
+}
+
+/// A register past the end of the function's registers is rejected when the body is threaded. A
+/// 64-bit register takes two slots, both of which must be in range.
+///
+TEST_F(TestInterpreter, ThreadingRejectsInvalidRegister) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(
+		instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 1,
+			[](FuncBuilder& fb) { fb.emit_x32_return(2); }),
+		ThreadingError);
+
+	EXPECT_THROW(
+		instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I64}), 1,
+			[](FuncBuilder& fb) { fb.emit_x64_return(1); }),
+		ThreadingError);
+
+	EXPECT_NO_THROW(instantiate_func(
+		cx, FuncType({ValType::I32}, {ValType::I64}), 1,
+		[](FuncBuilder& fb) { fb.emit_x64_return(0); }));
+}
+
+/// Wide register immediates are checked like narrow ones.
+///
+TEST_F(TestInterpreter, ThreadingRejectsInvalidWideRegister) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(
+		instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 299,
+			[](FuncBuilder& fb) {
+				fb.emit_i32_add(300, 0, 0);
+				fb.emit_x32_return(300);
+			}),
+		ThreadingError);
+}
+
+/// The argument block of a call must hold every argument of the callee.
+///
+TEST_F(TestInterpreter, ThreadingRejectsInvalidCallArgs) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(
+		instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 0,
+			[](FuncBuilder& fb) {
+				fb.emit_call(0, 1);
+				fb.emit_load_result_x32(0);
+				fb.emit_x32_return(0);
+			}),
+		ThreadingError);
+}
+
+/// A call is threaded into a call_quick, holding the callee, so threaded code is never rewritten
+/// as it runs.
+///
+TEST_F(TestInterpreter, CallIsQuickened) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		ModuleNode mod;
+		push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+
+		FuncNode& caller = push(mod.funcs);
+		caller.type_idx  = 0;
+		caller.nregs     = 0;
+		{
+			FuncBuilder fb;
+			fb.emit_call(1, 0);
+			fb.emit_load_result_x32(0);
+			fb.emit_x32_return(0);
+			caller.push<BytecodeInsnNode>(fb.finalize());
+		}
+
+		FuncNode& doubler = push(mod.funcs);
+		doubler.type_idx  = 0;
+		doubler.nregs     = 0;
+		{
+			FuncBuilder fb;
+			fb.emit_i32_add(0, 0, 0);
+			fb.emit_x32_return(0);
+			doubler.push<BytecodeInsnNode>(fb.finalize());
+		}
+
+		ModuleInst* inst = instantiate(cx, mod.write(), dispatch);
+		FuncInst* func   = inst->func_inst(0);
+
+		const void* const* handlers = handler_table(dispatch);
+		const Byte* body            = func->body();
+
+		EXPECT_EQ(
+			*reinterpret_cast<const void* const*>(body), handlers[RawOpcode(Opcode::CALL_QUICK)]);
+		EXPECT_EQ(
+			*reinterpret_cast<FuncInst* const*>(body + Threaded::CALL_QUICK_TGT_OFFSET),
+			inst->func_inst(1));
+		EXPECT_EQ(static_call<std::int32_t>(cx, func, 21), std::make_tuple(42));
+		EXPECT_EQ(
+			*reinterpret_cast<const void* const*>(body), handlers[RawOpcode(Opcode::CALL_QUICK)]);
+		EXPECT_EQ(static_call<std::int32_t>(cx, func, 5), std::make_tuple(10));
+	}
+}
+
+/// A call to a function index out of range is left unquickened, and traps when executed.
+///
+TEST_F(TestInterpreter, CallOutOfRangeTraps) {
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		auto inst = instantiate_func(
+			cx, FuncType({ValType::I32}, {ValType::I32}), 0,
+			[](FuncBuilder& fb) {
+				fb.emit_call(7, 0);
+				fb.emit_load_result_x32(0);
+				fb.emit_x32_return(0);
+			},
+			dispatch);
+		FuncInst* func = inst->func_inst(0);
+
+		const void* const* handlers = handler_table(dispatch);
+		EXPECT_EQ(
+			*reinterpret_cast<const void* const*>(func->body()), handlers[RawOpcode(Opcode::CALL)]);
+		EXPECT_EQ(trap_of<std::int32_t>(cx, func, 1), TrapKind::UNDEFINED_ELEMENT);
+	}
+}
+
+/// Globals are read and written through their slot, once the access has been quickened.
+///
+TEST_F(TestInterpreter, GlobalAccess) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.types, FuncType({}, {ValType::I64}));
+	push(mod.globals, GlobalEntry{ValType::I32, 7});
+	push(mod.globals, GlobalEntry{ValType::I64, std::uint64_t(1) << 40});
+
+	FuncNode& accumulate = push(mod.funcs);
+	accumulate.type_idx  = 0;
+	accumulate.nregs     = 1;
+	{
+		FuncBuilder fb;
+		fb.emit_get_global_x32(1, 0);
+		fb.emit_i32_add(1, 1, 0);
+		fb.emit_set_global_x32(0, 1);
+		fb.emit_x32_return(1);
+		accumulate.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& twice = push(mod.funcs);
+	twice.type_idx  = 1;
+	twice.nregs     = 2;
+	{
+		FuncBuilder fb;
+		fb.emit_get_global_x64(0, 1);
+		fb.emit_i64_add(0, 0, 0);
+		fb.emit_set_global_x64(1, 0);
+		fb.emit_x64_return(0);
+		twice.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_EQ(inst->shared_module()->global_table().size(), 2);
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 5), std::make_tuple(12));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 1), std::make_tuple(13));
+	EXPECT_EQ(*inst->global(0), 13);
+
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst->func_inst(1)),
+		std::make_tuple(std::int64_t(1) << 41));
+	EXPECT_EQ(static_call<std::int64_t>(cx, inst->func_inst(1)),
+		std::make_tuple(std::int64_t(1) << 42));
+	EXPECT_EQ(*inst->global(1), std::uint64_t(1) << 42);
+}
+
+/// A module with a memory of one page, and a function `(addr, value) -> i64` which stores value at
+/// addr with every store width, and sums the values loaded back with every load width.
+///
+ModuleInst* instantiate_memory_func(Context& cx, Dispatch dispatch, BoundsCheck bounds_check) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32, ValType::I64}, {ValType::I64}));
+	push(mod.memories, MemoryType{1, 2});
+
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 5;
+	{
+		FuncBuilder fb;
+		fb.emit_i64_store(0, 0, 1);
+		fb.emit_i64_load(3, 0, 0);
+		fb.emit_i64_load32_s(5, 0, 0);
+		fb.emit_i64_add(3, 3, 5);
+		fb.emit_i64_load16_u(5, 0, 0);
+		fb.emit_i64_add(3, 3, 5);
+		fb.emit_i64_load8_s(5, 0, 0);
+		fb.emit_i64_add(3, 3, 5);
+		fb.emit_i64_store8(0, 16, 1);
+		fb.emit_i32_load(7, 0, 16);
+		fb.emit_i64_extend_u_i32(5, 7);
+		fb.emit_i64_add(3, 3, 5);
+		fb.emit_x64_return(3);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	return instantiate(cx, mod.write(), dispatch, bounds_check);
+}
+
+/// Loads and stores of every width, at the start and the end of memory, with both dispatches and
+/// every bounds check. An access past the end of memory traps.
+///
+TEST_F(TestInterpreter, MemoryAccess) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	for (auto [dispatch, bounds_check] : {
+			 std::pair{Dispatch::COMPUTED_GOTO, BoundsCheck::GUARD_REGION},
+			 std::pair{Dispatch::COMPUTED_GOTO, BoundsCheck::EXPLICIT},
+			 std::pair{Dispatch::COMPUTED_GOTO, BoundsCheck::MASK},
+			 std::pair{Dispatch::TAIL_CALL, BoundsCheck::GUARD_REGION},
+			 std::pair{Dispatch::TAIL_CALL, BoundsCheck::EXPLICIT},
+			 std::pair{Dispatch::TAIL_CALL, BoundsCheck::MASK},
+		 }) {
+		ModuleInst* inst = instantiate_memory_func(cx, dispatch, bounds_check);
+		FuncInst* func   = inst->func_inst(0);
+
+		ASSERT_NE(inst->memory(), nullptr);
+		EXPECT_EQ(inst->memory()->bounds_check(), bounds_check);
+		EXPECT_EQ(inst->memory()->size(), LinearMemory::PAGE_SIZE);
+
+		std::int64_t value = std::int64_t(0x0123'4567'89ab'cdef);
+		std::int64_t sum   = value + std::int32_t(0x89ab'cdef) + 0xcdef + std::int8_t(0xef) + 0xef;
+
+		EXPECT_EQ(static_call<std::int64_t>(cx, func, 0, value), std::make_tuple(sum));
+		EXPECT_EQ(static_call<std::int64_t>(cx, func, 0x1000 - 3, value), std::make_tuple(sum));
+		EXPECT_EQ(to_ptr<Byte>(inst->memory()->address())[0x1000 + 13], Byte(0xef));
+
+		std::int32_t last = std::int32_t(LinearMemory::PAGE_SIZE - 8);
+		EXPECT_EQ(trap_of<std::int64_t>(cx, func, last, value), TrapKind::MEMORY_OUT_OF_BOUNDS);
+		EXPECT_EQ(trap_of<std::int64_t>(cx, func, last + 1, value), TrapKind::MEMORY_OUT_OF_BOUNDS);
+		EXPECT_EQ(trap_of<std::int64_t>(cx, func, -1, value), TrapKind::MEMORY_OUT_OF_BOUNDS);
+	}
+}
+
+/// Each bounds check reserves a different amount of address space. A masked memory wraps an
+/// access past the end of it's reservation back into the memory.
+///
+TEST_F(TestInterpreter, MemoryReservations) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	ModuleInst* guarded = instantiate_memory_func(cx, DEFAULT_DISPATCH, BoundsCheck::GUARD_REGION);
+	ModuleInst* checked = instantiate_memory_func(cx, DEFAULT_DISPATCH, BoundsCheck::EXPLICIT);
+	ModuleInst* masked  = instantiate_memory_func(cx, DEFAULT_DISPATCH, BoundsCheck::MASK);
+
+	EXPECT_EQ(guarded->memory()->reserved_size(), LinearMemory::GUARDED_RESERVATION);
+	EXPECT_EQ(checked->memory()->reserved_size(), 2 * LinearMemory::PAGE_SIZE);
+	EXPECT_EQ(masked->memory()->reserved_size(), 3 * LinearMemory::PAGE_SIZE);
+	EXPECT_EQ(masked->memory()->mask(), 2 * LinearMemory::PAGE_SIZE - 1);
+
+	std::int64_t value = 0x55;
+	std::int64_t sum   = 4 * value + value;
+	std::int32_t wraps = std::int32_t(2 * LinearMemory::PAGE_SIZE);
+
+	EXPECT_EQ(static_call<std::int64_t>(cx, masked->func_inst(0), wraps, value),
+		std::make_tuple(sum));
+	EXPECT_EQ(to_ptr<Byte>(masked->memory()->address())[0], Byte(value));
+	EXPECT_EQ(trap_of<std::int64_t>(cx, checked->func_inst(0), wraps, value),
+		TrapKind::MEMORY_OUT_OF_BOUNDS);
+}
+
+/// The effective address of an access does not wrap around the 32-bit index space.
+///
+TEST_F(TestInterpreter, MemoryOffsetDoesNotWrap) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 1});
+
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 1;
+	{
+		FuncBuilder fb;
+		fb.emit_i32_load(1, 0, 0xffff'ffff);
+		fb.emit_x32_return(1);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate(cx, mod.write());
+
+	EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(0), 1), TrapKind::MEMORY_OUT_OF_BOUNDS);
+	EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(0), -1), TrapKind::MEMORY_OUT_OF_BOUNDS);
+}
+
+/// Loads and stores are rejected at load time in a module without a memory.
+///
+TEST_F(TestInterpreter, MemoryAccessWithoutMemory) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	EXPECT_THROW(instantiate_func(cx, FuncType({ValType::I32}, {ValType::I32}), 0,
+					 [](FuncBuilder& fb) {
+						 fb.emit_i32_load(0, 0, 0);
+						 fb.emit_x32_return(0);
+					 }),
+		std::runtime_error);
+}
+
+/// memory.grow returns the old size, or -1 past the maximum. Grown pages are accessible, and pages
+/// past the end of memory still trap, under every bounds check.
+///
+TEST_F(TestInterpreter, MemoryGrow) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 3});
+
+	FuncNode& grow = push(mod.funcs);
+	grow.type_idx  = 0;
+	grow.nregs     = 2;
+	{
+		FuncBuilder fb;
+		fb.emit_grow_memory(1, 0);
+		fb.emit_current_memory(2);
+		fb.emit_i32_mul_ri(2, 2, 1000);
+		fb.emit_i32_add(1, 1, 2);
+		fb.emit_x32_return(1);
+		grow.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& load = push(mod.funcs);
+	load.type_idx  = 0;
+	load.nregs     = 1;
+	{
+		FuncBuilder fb;
+		fb.emit_i32_load(1, 0, 0);
+		fb.emit_x32_return(1);
+		load.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	auto module = compile(cx, mod.write());
+
+	for (BoundsCheck bounds_check :
+		{BoundsCheck::GUARD_REGION, BoundsCheck::EXPLICIT, BoundsCheck::MASK}) {
+		ModuleInst* inst = instantiate(cx, module, DEFAULT_DISPATCH, bounds_check);
+		std::int32_t end = std::int32_t(2 * LinearMemory::PAGE_SIZE - 4);
+
+		EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(1), end),
+			TrapKind::MEMORY_OUT_OF_BOUNDS);
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 0), std::make_tuple(1001));
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 1), std::make_tuple(2001));
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(1), end), std::make_tuple(0));
+		EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(1), end + 4),
+			TrapKind::MEMORY_OUT_OF_BOUNDS);
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 2), std::make_tuple(1999));
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 1), std::make_tuple(3002));
+		EXPECT_EQ(inst->memory()->page_count(), 3);
+	}
+}
+
+/// Instances of a VM with a memory pool take their memories from it, and return them when they are
+/// destroyed.
+///
+TEST_F(TestInterpreter, PooledMemory) {
+	LinearMemoryPoolConfig pool_config;
+	pool_config.slot_count     = 2;
+	pool_config.page_count_max = 4;
+	pool_config.bounds_check   = BoundsCheck::MASK;
+
+	VirtualMachine vm(runtime(), pool_config);
+	Context cx(&vm);
+
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 2});
+
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 1;
+	{
+		FuncBuilder fb;
+		fb.emit_i32_load(1, 0, 0);
+		fb.emit_i32_add_ri(1, 1, 1);
+		fb.emit_i32_store(0, 0, 1);
+		fb.emit_x32_return(1);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	auto module = compile(cx, mod.write());
+
+	for (int i = 0; i < 3; ++i) {
+		std::unique_ptr<ModuleInst> inst(instantiate(cx, module));
+		ASSERT_EQ(inst->memory()->pool(), vm.memory_pool());
+		EXPECT_EQ(inst->memory()->bounds_check(), BoundsCheck::MASK);
+		EXPECT_EQ(vm.memory_pool()->available(), 1);
+
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 8), std::make_tuple(1));
+		EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 8), std::make_tuple(2));
+		EXPECT_EQ(trap_of<std::int32_t>(cx, inst->func_inst(0), 0x10000),
+			TrapKind::MEMORY_OUT_OF_BOUNDS);
+	}
+
+	EXPECT_EQ(vm.memory_pool()->available(), 2);
+}
+
+/// An instance made from a snapshot starts with the snapshot's globals and memory, and it's writes
+/// are not seen by the original, or by any other instance of the snapshot.
+///
+TEST_F(TestInterpreter, Snapshot) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 2});
+	push(mod.globals, GlobalEntry{ValType::I32, 0});
+
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 3;
+	{
+		FuncBuilder fb;
+		fb.emit_get_global_x32(1, 0);
+		fb.emit_i32_add(1, 1, 0);
+		fb.emit_set_global_x32(0, 1);
+		fb.emit_x32_const(3, 0);
+		fb.emit_i32_load(2, 3, 0);
+		fb.emit_i32_add(2, 2, 0);
+		fb.emit_i32_store(3, 0, 2);
+		fb.emit_i32_add(1, 1, 2);
+		fb.emit_x32_return(1);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	std::unique_ptr<ModuleInst> original(instantiate(cx, mod.write()));
+	EXPECT_EQ(static_call<std::int32_t>(cx, original->func_inst(0), 5), std::make_tuple(10));
+
+	auto snapshot = original->snapshot();
+	EXPECT_EQ(snapshot->globals, std::vector<std::uint64_t>{5});
+	EXPECT_EQ(snapshot->memory_image->page_count(), 1);
+
+	EXPECT_EQ(static_call<std::int32_t>(cx, original->func_inst(0), 1), std::make_tuple(12));
+
+	for (Dispatch dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		std::unique_ptr<ModuleInst> a(instantiate(cx, *snapshot, dispatch));
+		std::unique_ptr<ModuleInst> b(instantiate(cx, *snapshot, dispatch));
+		EXPECT_EQ(*a->global(0), 5);
+		EXPECT_EQ(a->memory()->image_page_count(), 1);
+
+		EXPECT_EQ(static_call<std::int32_t>(cx, a->func_inst(0), 1), std::make_tuple(12));
+		EXPECT_EQ(static_call<std::int32_t>(cx, a->func_inst(0), 1), std::make_tuple(14));
+		EXPECT_EQ(static_call<std::int32_t>(cx, b->func_inst(0), 2), std::make_tuple(14));
+
+		a->memory()->reset();
+		EXPECT_EQ(*to_ptr<std::int32_t>(a->memory()->address()), 5);
+	}
+
+	EXPECT_EQ(*original->global(0), 6);
+	EXPECT_EQ(*to_ptr<std::int32_t>(original->memory()->address()), 6);
+}
+
+/// Resetting an instance restores it's globals and memory, whether it was instantiated from a
+/// module or a snapshot.
+///
+TEST_F(TestInterpreter, Reset) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 4});
+	push(mod.globals, GlobalEntry{ValType::I32, 3});
+
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 2;
+	{
+		FuncBuilder fb;
+		fb.emit_get_global_x32(1, 0);
+		fb.emit_i32_add(1, 1, 0);
+		fb.emit_set_global_x32(0, 1);
+		fb.emit_x32_const(2, 1);
+		fb.emit_grow_memory(2, 2);
+		fb.emit_x32_const(2, 0);
+		fb.emit_i32_store(2, 0x10000, 1);
+		fb.emit_i32_load(2, 2, 0x10000);
+		fb.emit_x32_return(2);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	std::unique_ptr<ModuleInst> inst(instantiate(cx, mod.write()));
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 4), std::make_tuple(7));
+	EXPECT_EQ(inst->memory()->page_count(), 2);
+
+	inst->reset();
+	EXPECT_EQ(*inst->global(0), 3);
+	EXPECT_EQ(inst->memory()->page_count(), 1);
+	EXPECT_EQ(static_call<std::int32_t>(cx, inst->func_inst(0), 4), std::make_tuple(7));
+
+	auto snapshot = inst->snapshot();
+	std::unique_ptr<ModuleInst> copy(instantiate(cx, *snapshot));
+	EXPECT_EQ(static_call<std::int32_t>(cx, copy->func_inst(0), 1), std::make_tuple(8));
+
+	copy->reset();
+	EXPECT_EQ(*copy->global(0), 7);
+	EXPECT_EQ(copy->memory()->page_count(), 2);
+	EXPECT_EQ(*to_ptr<std::int32_t>(copy->memory()->address() + 0x10000), 7);
+}
+
+/// A module with a one page memory, a data segment, and a function `(to, from, len) -> i32` per
+/// bulk operator: fill, copy, init, and drop, which ignores it's arguments.
+///
+ModuleInst* instantiate_bulk_memory_funcs(
+	Context& cx, Dispatch dispatch, BoundsCheck bounds_check) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32, ValType::I32, ValType::I32}, {ValType::I32}));
+	push(mod.memories, MemoryType{1, 1});
+	push(mod.data, std::vector<Byte>{'h', 'e', 'l', 'l', 'o', ',', ' ', 'w', 'o', 'r', 'l', 'd'});
+
+	for (std::size_t i = 0; i < 4; ++i) {
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = 1;
+
+		FuncBuilder fb;
+		switch (i) {
+		case 0:
+			fb.emit_memory_fill(0, 1, 2);
+			break;
+		case 1:
+			fb.emit_memory_copy(0, 1, 2);
+			break;
+		case 2:
+			fb.emit_memory_init(0, 0, 1, 2);
+			break;
+		case 3:
+			fb.emit_data_drop(0);
+			break;
+		}
+		fb.emit_x32_const(3, 0);
+		fb.emit_x32_return(3);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	return instantiate(cx, mod.write(), dispatch, bounds_check);
+}
+
+/// Bulk memory operators, with both dispatches and every bounds check. An operator with any part
+/// of it's range out of bounds traps before writing anything.
+///
+TEST_F(TestInterpreter, BulkMemory) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+
+	constexpr std::int32_t END = std::int32_t(LinearMemory::PAGE_SIZE);
+
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		for (auto bounds_check :
+			{BoundsCheck::GUARD_REGION, BoundsCheck::EXPLICIT, BoundsCheck::MASK}) {
+			std::unique_ptr<ModuleInst> inst(
+				instantiate_bulk_memory_funcs(cx, dispatch, bounds_check));
+			Byte* memory = to_ptr<Byte>(inst->memory()->address());
+
+			FuncInst* fill = inst->func_inst(0);
+			FuncInst* copy = inst->func_inst(1);
+			FuncInst* init = inst->func_inst(2);
+			FuncInst* drop = inst->func_inst(3);
+
+			static_call<std::int32_t>(cx, fill, 0x100, 0x1ab, 0x1000);
+			EXPECT_EQ(memory[0xff], 0);
+			EXPECT_EQ(memory[0x100], 0xab);
+			EXPECT_EQ(memory[0x10ff], 0xab);
+			EXPECT_EQ(memory[0x1100], 0);
+
+			static_call<std::int32_t>(cx, copy, 0x8000, 0x0, 0x2000);
+			EXPECT_EQ(std::memcmp(memory + 0x8000, memory, 0x2000), 0);
+
+			memory[0x100] = 1;
+			static_call<std::int32_t>(cx, copy, 0x101, 0x100, 0x1000);
+			EXPECT_EQ(memory[0x100], 1);
+			EXPECT_EQ(memory[0x101], 1);
+			EXPECT_EQ(memory[0x102], 0xab);
+
+			static_call<std::int32_t>(cx, init, END - 5, 7, 5);
+			EXPECT_EQ(std::memcmp(memory + END - 5, "world", 5), 0);
+
+			constexpr TrapKind OOB = TrapKind::MEMORY_OUT_OF_BOUNDS;
+			EXPECT_EQ(trap_of<std::int32_t>(cx, fill, END - 4, 1, 5), OOB);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, fill, 0, 1, -1), OOB);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, copy, 0, END - 4, 5), OOB);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, copy, -1, 0, 1), OOB);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, init, 0, 8, 5), OOB);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, init, END, 0, 1), OOB);
+			EXPECT_EQ(memory[END - 4], 'o');
+			EXPECT_EQ(memory[0], 0);
+
+			EXPECT_EQ(trap_of<std::int32_t>(cx, fill, END, 1, 0), TrapKind::NONE);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, init, END, 12, 0), TrapKind::NONE);
+
+			static_call<std::int32_t>(cx, drop, 0, 0, 0);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, init, 0, 0, 1), OOB);
+			EXPECT_EQ(trap_of<std::int32_t>(cx, init, 0, 0, 0), TrapKind::NONE);
+
+			inst->reset();
+			static_call<std::int32_t>(cx, init, 0, 0, 5);
+			EXPECT_EQ(std::memcmp(memory, "hello", 5), 0);
+		}
+	}
+}
+
+/// An indirect call checks the callee's index and signature every time it executes.
+///
+TEST_F(TestInterpreter, CallIndirect) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.types, FuncType({}, {}));
+
+	FuncNode& dispatcher = push(mod.funcs);
+	dispatcher.type_idx  = 0;
+	dispatcher.nregs     = 1;
+	{
+		FuncBuilder fb;
+		fb.emit_x32_const(1, 21);
+		fb.emit_call_indirect(0, 0, 1);
+		fb.emit_load_result_x32(1);
+		fb.emit_x32_return(1);
+		dispatcher.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& doubler = push(mod.funcs);
+	doubler.type_idx  = 0;
+	doubler.nregs     = 0;
+	{
+		FuncBuilder fb;
+		fb.emit_i32_add(0, 0, 0);
+		fb.emit_x32_return(0);
+		doubler.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	FuncNode& nothing = push(mod.funcs);
+	nothing.type_idx  = 1;
+	nothing.nregs     = 0;
+	nothing.push<ReturnInsnNode>();
+
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		ModuleInst* inst = instantiate(cx, mod.write(), dispatch);
+		FuncInst* func   = inst->func_inst(0);
+
+		EXPECT_EQ(static_call<std::int32_t>(cx, func, 1), std::make_tuple(42));
+		EXPECT_EQ(trap_of<std::int32_t>(cx, func, 2), TrapKind::INDIRECT_CALL_TYPE_MISMATCH);
+		EXPECT_EQ(trap_of<std::int32_t>(cx, func, 3), TrapKind::UNDEFINED_ELEMENT);
+		EXPECT_EQ(static_call<std::int32_t>(cx, func, 1), std::make_tuple(42));
+	}
+}
+
 #if 0
 
 TEST(TestInterpreter, BranchOverNop) {
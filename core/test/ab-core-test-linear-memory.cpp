@@ -1,6 +1,7 @@
 #include <Ab/Config.hpp>
 #include <Ab/LinearMemory.hpp>
 #include <gtest/gtest.h>
+#include <cstring>
 
 namespace Ab::Test {
 
@@ -31,4 +32,338 @@ TEST(LinearMemoryTest, AssignToMemory) {
 	EXPECT_EQ(*ptr, 123);
 }
 
+TEST(LinearMemoryTest, GuardRegion) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 2;
+	cfg.bounds_check   = BoundsCheck::GUARD_REGION;
+
+	LinearMemory m(cfg);
+
+	EXPECT_EQ(m.size(), LinearMemory::PAGE_SIZE);
+	EXPECT_EQ(m.max_size(), 2 * LinearMemory::PAGE_SIZE);
+	EXPECT_EQ(m.reserved_size(), LinearMemory::GUARDED_RESERVATION);
+
+	auto base = to_ptr<Byte>(m.address());
+	EXPECT_TRUE(m.reserves(base));
+	EXPECT_TRUE(m.reserves(base + 0xffff'ffffull + 0xffff'ffffull + 7));
+	EXPECT_FALSE(m.reserves(base + LinearMemory::GUARDED_RESERVATION));
+	EXPECT_FALSE(m.reserves(base - 1));
+}
+
+TEST(LinearMemoryTest, GuardRegionLimitsPageCount) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_max = LinearMemoryConfig::MAX_PAGE_COUNT + 1;
+	cfg.bounds_check   = BoundsCheck::GUARD_REGION;
+
+	EXPECT_THROW(LinearMemory m(cfg), LinearMemoryError);
+}
+
+TEST(LinearMemoryTest, ExplicitGrowCommitsInChunks) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 0;
+	cfg.page_count_max = 40;
+	cfg.commit_chunk   = 4;
+	cfg.bounds_check   = BoundsCheck::EXPLICIT;
+
+	LinearMemory m(cfg);
+	EXPECT_EQ(m.committed_page_count(), 0);
+
+	m.grow();
+	EXPECT_EQ(m.page_count(), 1);
+	EXPECT_EQ(m.committed_page_count(), 4);
+
+	for (std::size_t i = 1; i < 5; i++) {
+		m.grow();
+	}
+	EXPECT_EQ(m.page_count(), 5);
+	EXPECT_EQ(m.committed_page_count(), 8);
+
+	m.grow(20);
+	EXPECT_EQ(m.committed_page_count(), 25);
+
+	m.grow();
+	EXPECT_EQ(m.committed_page_count(), 40);
+
+	EXPECT_FALSE(m.try_grow(15));
+	EXPECT_EQ(m.page_count(), 26);
+	EXPECT_TRUE(m.try_grow(14));
+	EXPECT_THROW(m.grow(), LinearMemoryError);
+}
+
+TEST(LinearMemoryTest, GuardedGrowCommitsExactly) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 8;
+	cfg.bounds_check   = BoundsCheck::GUARD_REGION;
+	cfg.prefault       = true;
+
+	LinearMemory m(cfg);
+	m.grow(2);
+
+	EXPECT_EQ(m.page_count(), 3);
+	EXPECT_EQ(m.committed_page_count(), 3);
+
+	auto ptr = to_ptr<int>(m.address() + 2 * LinearMemory::PAGE_SIZE);
+	*ptr     = 123;
+	EXPECT_EQ(*ptr, 123);
+
+	m.shrink(2);
+	EXPECT_EQ(m.page_count(), 1);
+	EXPECT_EQ(m.committed_page_count(), 1);
+}
+
+TEST(LinearMemoryTest, ShrinkDiscardsPages) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 4;
+
+	LinearMemory m(cfg);
+	m.grow();
+
+	auto ptr = to_ptr<int>(m.address() + LinearMemory::PAGE_SIZE);
+	*ptr     = 123;
+
+	m.shrink();
+	EXPECT_EQ(m.page_count(), 1);
+	m.grow();
+	EXPECT_EQ(*ptr, 0);
+}
+
+TEST(LinearMemoryTest, Reset) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 4;
+
+	LinearMemory m(cfg);
+	m.grow(2);
+
+	auto ptr = to_ptr<int>(m.address());
+	*ptr     = 123;
+
+	m.reset();
+	EXPECT_EQ(m.page_count(), 1);
+	EXPECT_EQ(*ptr, 0);
+
+	// A memory shrunk below it's minimum grows back.
+	m.shrink();
+	m.reset();
+	EXPECT_EQ(m.page_count(), 1);
+	EXPECT_EQ(*ptr, 0);
+}
+
+/// Views are checked against the current size of the memory, and stay valid as it grows.
+///
+TEST(LinearMemoryTest, Views) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 2;
+
+	LinearMemory m(cfg);
+
+	constexpr std::uint32_t END = LinearMemory::PAGE_SIZE;
+
+	std::span<Byte> bytes = m.bytes(END - 8, 8);
+	EXPECT_EQ(bytes.data(), to_ptr<Byte>(m.address()) + END - 8);
+	EXPECT_EQ(m.bytes(END, 0).size(), 0);
+	EXPECT_THROW(m.bytes(END - 8, 9), LinearMemoryError);
+	EXPECT_THROW(m.bytes(0xffff'ffff, 2), LinearMemoryError);
+
+	std::span<std::uint32_t> words = m.view<std::uint32_t>(END - 8, 2);
+	EXPECT_EQ(words.size(), 2);
+
+	words[1] = 0x0403'0201;
+	EXPECT_EQ(bytes[4], 0x01);
+	EXPECT_EQ(bytes[7], 0x04);
+	EXPECT_THROW(m.view<std::uint32_t>(END - 6), LinearMemoryError);
+	EXPECT_THROW(m.view<std::uint32_t>(END - 4, 2), LinearMemoryError);
+	EXPECT_THROW(m.view<std::uint32_t>(END - 4, 0x4000'0001), LinearMemoryError);
+
+	m.grow();
+	EXPECT_EQ(words[1], 0x0403'0201);
+	EXPECT_EQ(m.view<std::uint32_t>(END - 4, 2)[0], 0x0403'0201);
+}
+
+/// Guest iovecs translate to host iovecs into the memory, which read and write guest buffers in
+/// place.
+///
+TEST(LinearMemoryTest, IoVecs) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 1;
+
+	LinearMemory m(cfg);
+
+	std::span<GuestIoVec> guest = m.view<GuestIoVec>(0x100, 3);
+	guest[0]                    = GuestIoVec{0x1000, 5};
+	guest[1]                    = GuestIoVec{0x2000, 0};
+	guest[2]                    = GuestIoVec{0x3000, 6};
+	std::memcpy(to_ptr<Byte>(m.address()) + 0x1000, "hello", 5);
+	std::memcpy(to_ptr<Byte>(m.address()) + 0x3000, " world", 6);
+
+	IoVecBuilder builder;
+	builder.append(m, 0x100, 3);
+	EXPECT_EQ(builder.count(), 3);
+	EXPECT_EQ(builder.size(), 11);
+	EXPECT_EQ(builder.data()[0].iov_base, to_ptr<Byte>(m.address()) + 0x1000);
+
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	EXPECT_EQ(writev(fds[1], builder.data(), int(builder.count())), 11);
+
+	guest[0] = GuestIoVec{0x4000, 6};
+	guest[1] = GuestIoVec{0x5000, 5};
+	builder.clear();
+	builder.append(m, 0x100, 2);
+	EXPECT_EQ(readv(fds[0], builder.data(), int(builder.count())), 11);
+	EXPECT_EQ(std::memcmp(to_ptr<Byte>(m.address()) + 0x4000, "hello ", 6), 0);
+	EXPECT_EQ(std::memcmp(to_ptr<Byte>(m.address()) + 0x5000, "world", 5), 0);
+	close(fds[0]);
+	close(fds[1]);
+
+	guest[1] = GuestIoVec{LinearMemory::PAGE_SIZE - 4, 5};
+	EXPECT_THROW(builder.append(m, 0x100, 2), LinearMemoryError);
+	EXPECT_THROW(builder.append(m, LinearMemory::PAGE_SIZE - 4, 1), LinearMemoryError);
+}
+
+TEST(LinearMemoryTest, MapImage) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 4;
+
+	LinearMemory original(cfg);
+	original.grow();
+	*to_ptr<int>(original.address())                          = 123;
+	*to_ptr<int>(original.address() + LinearMemory::PAGE_SIZE) = 456;
+
+	MemoryImage image(original);
+	EXPECT_EQ(image.page_count(), 2);
+
+	LinearMemory a(cfg);
+	LinearMemory b(cfg);
+	a.map_image(image);
+	b.map_image(image);
+	EXPECT_EQ(a.page_count(), 2);
+	EXPECT_EQ(a.image_page_count(), 2);
+
+	// Writes are private to each memory.
+
+	*to_ptr<int>(a.address()) = 789;
+	EXPECT_EQ(*to_ptr<int>(b.address()), 123);
+	EXPECT_EQ(*to_ptr<int>(original.address()), 123);
+
+	// Resetting restores the image.
+
+	a.grow();
+	a.reset();
+	EXPECT_EQ(a.page_count(), 2);
+	EXPECT_EQ(*to_ptr<int>(a.address()), 123);
+
+	// Shrinking below the image drops it.
+
+	a.shrink();
+	a.grow();
+	EXPECT_EQ(a.image_page_count(), 1);
+	EXPECT_EQ(*to_ptr<int>(a.address() + LinearMemory::PAGE_SIZE), 0);
+
+	// Resetting maps the dropped pages again, and regrows a memory shrunk below it's image.
+
+	a.shrink(2);
+	a.reset();
+	EXPECT_EQ(a.page_count(), 2);
+	EXPECT_EQ(a.image_page_count(), 2);
+	EXPECT_EQ(*to_ptr<int>(a.address()), 123);
+	EXPECT_EQ(*to_ptr<int>(a.address() + LinearMemory::PAGE_SIZE), 456);
+
+	cfg.page_count_max = 1;
+	LinearMemory c(cfg);
+	EXPECT_THROW(c.map_image(image), LinearMemoryError);
+}
+
+TEST(LinearMemoryTest, HugePages) {
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 32;
+	cfg.page_count_max = 64;
+	cfg.huge_pages     = HugePages::TRANSPARENT;
+
+	LinearMemory m(cfg);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(m.address()) % Page::huge_size(), 0);
+
+	for (std::size_t i = 0; i < m.size(); i += Page::size()) {
+		m.address()[i] = 1;
+	}
+	EXPECT_LE(m.huge_resident_size(), m.reserved_size());
+
+	LinearMemoryPoolConfig pool_cfg;
+	pool_cfg.slot_count     = 2;
+	pool_cfg.page_count_max = 64;
+	pool_cfg.bounds_check   = BoundsCheck::EXPLICIT;
+	pool_cfg.huge_pages     = HugePages::TRANSPARENT;
+
+	LinearMemoryPool pool(pool_cfg);
+	EXPECT_EQ(pool.slot_size() % Page::huge_size(), 0);
+
+	cfg.bounds_check = BoundsCheck::EXPLICIT;
+	cfg.huge_pages   = HugePages::NONE;
+	LinearMemory pooled(cfg, pool);
+	EXPECT_EQ(pooled.config().huge_pages, HugePages::TRANSPARENT);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(pooled.address()) % Page::huge_size(), 0);
+}
+
+TEST(LinearMemoryTest, PoolReusesSlots) {
+	LinearMemoryPoolConfig pool_cfg;
+	pool_cfg.slot_count     = 2;
+	pool_cfg.page_count_max = 4;
+	pool_cfg.bounds_check   = BoundsCheck::EXPLICIT;
+
+	LinearMemoryPool pool(pool_cfg);
+	EXPECT_EQ(pool.slot_size(), 4 * LinearMemory::PAGE_SIZE);
+
+	LinearMemoryConfig cfg;
+	cfg.page_count_min = 1;
+	cfg.page_count_max = 2;
+	cfg.bounds_check   = BoundsCheck::EXPLICIT;
+
+	MutAddress first = nullptr;
+	{
+		LinearMemory a(cfg, pool);
+		LinearMemory b(cfg, pool);
+		EXPECT_EQ(pool.available(), 0);
+		EXPECT_THROW(LinearMemory c(cfg, pool), LinearMemoryError);
+		EXPECT_EQ(a.reserved_size(), pool.slot_size());
+
+		first                     = a.address();
+		*to_ptr<int>(a.address()) = 123;
+		*to_ptr<int>(b.address()) = 456;
+	}
+	EXPECT_EQ(pool.available(), 2);
+
+	LinearMemory c(cfg, pool);
+	EXPECT_EQ(c.address(), first);
+	EXPECT_EQ(*to_ptr<int>(c.address()), 0);
+	EXPECT_EQ(c.committed_page_count(), 2);
+
+	cfg.page_count_max = 5;
+	EXPECT_FALSE(pool.fits(cfg));
+	EXPECT_THROW(LinearMemory d(cfg, pool), LinearMemoryError);
+}
+
+TEST(LinearMemoryTest, GuardedPool) {
+	LinearMemoryPoolConfig pool_cfg;
+	pool_cfg.slot_count   = 2;
+	pool_cfg.bounds_check = BoundsCheck::GUARD_REGION;
+
+	LinearMemoryPool pool(pool_cfg);
+	EXPECT_EQ(pool.slot_size(), LinearMemory::GUARDED_RESERVATION);
+
+	LinearMemoryConfig cfg;
+	cfg.bounds_check = BoundsCheck::GUARD_REGION;
+
+	LinearMemory a(cfg, pool);
+	LinearMemory b(cfg, pool);
+	EXPECT_EQ(a.committed_page_count(), 1);
+	EXPECT_TRUE(a.reserves(a.address() + LinearMemory::GUARDED_RESERVATION - 1));
+	EXPECT_FALSE(a.reserves(b.address()) && b.reserves(a.address()));
+}
+
 }  // namespace Ab::Test
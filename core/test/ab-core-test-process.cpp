@@ -1,5 +1,8 @@
+#include <Ab/Process.hpp>
 #include <Ab/Runtime.hpp>
+#include <algorithm>
 #include <gtest/gtest.h>
+#include <sched.h>
 
 namespace Ab {
 namespace Test {
@@ -15,5 +18,23 @@ TEST(TestProcess, StartAndStop) {
 	}
 }
 
+TEST(TestProcess, NumaTopology) {
+	const SystemProperties& properties = Process::properties();
+	ASSERT_GE(properties.numa_node_count(), 1);
+
+	unsigned node = Process::current_numa_node();
+	EXPECT_LT(node, properties.numa_node_count());
+
+	const auto& cpus = properties.numa_node_cpus(node);
+	EXPECT_NE(std::find(cpus.begin(), cpus.end(), unsigned(sched_getcpu())), cpus.end());
+	EXPECT_TRUE(properties.numa_node_cpus(properties.numa_node_count()).empty());
+
+	cpu_set_t affinity;
+	ASSERT_EQ(sched_getaffinity(0, sizeof(affinity), &affinity), 0);
+	EXPECT_TRUE(Process::pin_thread_to_numa_node(node));
+	EXPECT_EQ(Process::current_numa_node(), node);
+	sched_setaffinity(0, sizeof(affinity), &affinity);
+}
+
 }  // namespace Test
 }  // namespace Ab
@@ -0,0 +1,189 @@
+#include <Ab/Config.hpp>
+#include <Ab/FuncBuilder.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/ModuleWriter.hpp>
+#include <Ab/Scheduler.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <gtest/gtest.h>
+
+namespace Ab::Test {
+
+class TestScheduler : public BasicTest {};
+
+/// Instantiate a module with three functions, which halt as they go:
+///   0. (n) -> n + (n - 1) + ... + 1, halting once per iteration.
+///   1. (n) -> 1 + func0(n), halting in the callee.
+///   2. () -> (), halting, then trapping.
+///   3. (n) -> n + (n - 1) + ... + 1, without halting.
+///
+ModuleInst* instantiate_halting_funcs(Context& cx, Dispatch dispatch = DEFAULT_DISPATCH) {
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	push(mod.types, FuncType({}, {}));
+
+	{
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = 1;
+
+		FuncBuilder fb;
+		auto loop = fb.make_label();
+		auto body = fb.make_label();
+		fb.emit_x32_const(1, 0);
+		fb.place(loop);
+		fb.emit_goto_if(0, body);
+		fb.emit_x32_return(1);
+		fb.place(body);
+		fb.emit_i32_add(1, 1, 0);
+		fb.emit_i32_sub_ri(0, 0, 1);
+		fb.emit_halt();
+		fb.emit_goto(loop);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	{
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = 2;
+
+		FuncBuilder fb;
+		fb.emit_call(0, 0);
+		fb.emit_load_result_x32(1);
+		fb.emit_i32_add_ri(1, 1, 1);
+		fb.emit_x32_return(1);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	{
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 1;
+		func.nregs     = 0;
+
+		FuncBuilder fb;
+		fb.emit_halt();
+		fb.emit_unreachable();
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	{
+		FuncNode& func = push(mod.funcs);
+		func.type_idx  = 0;
+		func.nregs     = 1;
+
+		FuncBuilder fb;
+		auto loop = fb.make_label();
+		auto body = fb.make_label();
+		fb.emit_x32_const(1, 0);
+		fb.place(loop);
+		fb.emit_goto_if(0, body);
+		fb.emit_x32_return(1);
+		fb.place(body);
+		fb.emit_i32_add(1, 1, 0);
+		fb.emit_i32_sub_ri(0, 0, 1);
+		fb.emit_goto(loop);
+		func.push<BytecodeInsnNode>(fb.finalize());
+	}
+
+	return instantiate(cx, mod.write(), dispatch);
+}
+
+/// Execution suspended at a halt, in a nested frame, resumes after the halt.
+///
+TEST_F(TestScheduler, ResumeAfterHalt) {
+	for (auto dispatch : {Dispatch::COMPUTED_GOTO, Dispatch::TAIL_CALL}) {
+		VirtualMachine vm(runtime());
+		Context cx(&vm);
+		FuncInst* func = instantiate_halting_funcs(cx, dispatch)->func_inst(1);
+
+		Byte* sp      = cx.exec_state().st_a.sp;
+		Byte* reg_ptr = enter_native_frame(cx, func->nregs());
+		set_stack_elements<std::int32_t>(reg_ptr, 10);
+
+		Byte* ret_ptr = enter_interpreter(cx, func);
+		int suspended = 0;
+		while (cx.exec_state().st_b.condition == ExecCond::SUSPENDED) {
+			suspended += 1;
+			ret_ptr = resume_interpreter(cx);
+		}
+
+		EXPECT_EQ(suspended, 10);
+		EXPECT_FALSE(cx.exec_state().st_b.flags.trap);
+		EXPECT_EQ(get_stack_elements<std::int32_t>(ret_ptr), std::make_tuple(56));
+
+		leave_native_frame(cx, func->nregs());
+		EXPECT_EQ(cx.exec_state().st_a.sp, sp);
+	}
+}
+
+/// Many tasks, suspending at every iteration, share a few workers, and all finish.
+///
+TEST_F(TestScheduler, RunTasks) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate_halting_funcs(cx);
+
+	SchedulerConfig config;
+	config.worker_count = 4;
+	Scheduler scheduler(&vm, config);
+	EXPECT_EQ(scheduler.worker_count(), 4);
+
+	std::vector<std::unique_ptr<Task>> tasks;
+	for (std::int32_t n = 0; n < 64; ++n) {
+		tasks.push_back(scheduler.spawn(inst->func_inst(n % 2), n));
+	}
+
+	for (std::int32_t n = 0; n < 64; ++n) {
+		Task& task = *tasks[n];
+		EXPECT_EQ(task.results<std::int32_t>(), std::make_tuple(n * (n + 1) / 2 + n % 2));
+		EXPECT_EQ(task.state(), TaskState::DONE);
+		EXPECT_EQ(task.resume_count(), std::size_t(n));
+	}
+}
+
+/// Tasks which never halt are preempted when their time slice runs out, and resumed.
+///
+TEST_F(TestScheduler, PreemptLongTasks) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate_halting_funcs(cx);
+
+	SchedulerConfig config;
+	config.worker_count = 2;
+	config.time_slice   = 1000;
+	Scheduler scheduler(&vm, config);
+
+	std::vector<std::unique_ptr<Task>> tasks;
+	for (int i = 0; i < 8; ++i) {
+		tasks.push_back(scheduler.spawn(inst->func_inst(3), 10000));
+	}
+
+	for (auto& task : tasks) {
+		EXPECT_EQ(task->results<std::int32_t>(), std::make_tuple(50005000));
+		EXPECT_EQ(task->resume_count(), 10);
+	}
+}
+
+/// A task which traps after being resumed raises the trap from results.
+///
+TEST_F(TestScheduler, TrapAfterResume) {
+	VirtualMachine vm(runtime());
+	Context cx(&vm);
+	ModuleInst* inst = instantiate_halting_funcs(cx);
+
+	Scheduler scheduler(&vm);
+	auto task = scheduler.spawn(inst->func_inst(2));
+
+	try {
+		task->results<>();
+		ADD_FAILURE() << "expected a trap";
+	} catch (const TrapError& e) {
+		EXPECT_EQ(e.kind(), TrapKind::UNREACHABLE);
+	}
+	EXPECT_EQ(task->state(), TaskState::TRAPPED);
+	EXPECT_EQ(task->resume_count(), 1);
+}
+
+}  // namespace Ab::Test
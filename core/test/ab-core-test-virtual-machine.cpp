@@ -0,0 +1,82 @@
+#include <Ab/Config.hpp>
+#include <Ab/FuncBuilder.hpp>
+#include <Ab/Loading.hpp>
+#include <Ab/ModuleBuilder.hpp>
+#include <Ab/ModuleWriter.hpp>
+#include <Ab/Test/BasicTest.hpp>
+#include <Ab/Test/RuntimeEnv.hpp>
+#include <Ab/VirtualMachine.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Ab::Test {
+
+class TestVirtualMachine : public BasicTest {};
+
+/// Many threads attach contexts, instantiate, and register instances at once, while another
+/// thread walks the contexts.
+///
+TEST_F(TestVirtualMachine, ConcurrentContextsAndInstances) {
+	constexpr std::size_t THREAD_COUNT    = 8;
+	constexpr std::size_t ITERATION_COUNT = 50;
+
+	VirtualMachine vm(runtime());
+
+	ModuleNode mod;
+	push(mod.types, FuncType({ValType::I32}, {ValType::I32}));
+	FuncNode& func = push(mod.funcs);
+	func.type_idx  = 0;
+	func.nregs     = 1;
+	FuncBuilder fb;
+	fb.emit_i32_add_ri(1, 0, 1);
+	fb.emit_x32_return(1);
+	func.push<BytecodeInsnNode>(fb.finalize());
+
+	std::shared_ptr<Module> module;
+	{
+		Context cx(&vm);
+		module = compile(cx, mod.write());
+	}
+
+	std::atomic<bool> done          = false;
+	std::atomic<std::size_t> errors = 0;
+
+	std::thread walker([&] {
+		while (!done) {
+			vm.for_each_context([&](Context& cx) {
+				if (cx.vm() != &vm) {
+					errors += 1;
+				}
+			});
+		}
+	});
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < THREAD_COUNT; ++i) {
+		threads.emplace_back([&, i] {
+			for (std::size_t j = 0; j < ITERATION_COUNT; ++j) {
+				Context cx(&vm);
+				std::unique_ptr<ModuleInst> owned(instantiate(cx, module));
+				ModuleInst* inst = vm.add_module(std::move(owned));
+				std::int32_t arg = std::int32_t(i);
+				auto [result]    = static_call<std::int32_t>(cx, inst->func_inst(0), arg);
+				if (result != arg + 1) {
+					errors += 1;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	done = true;
+	walker.join();
+
+	EXPECT_EQ(errors, 0u);
+	EXPECT_EQ(vm.module_count(), THREAD_COUNT * ITERATION_COUNT);
+	EXPECT_TRUE(vm.context_list().empty());
+}
+
+}  // namespace Ab::Test
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+# abx-superinstructions --operators <yaml> --profile <yaml> [--count N] <out>
+#
+# Select the hottest fusible operator pairs from an ABX opcode-sequence profile,
+# and assign each of them a free opcode. The output is a yaml datafile, which the
+# jinja templates load as `data.abx_superinstructions`.
+#
+# A profile is a yaml list of adjacent operator pairs, and how often each pair was
+# executed:
+#
+#   - ops: [i32.add, x32.return]
+#     count: 1234
+#
+# A pair is fusible when the first operator has a generated handler (an `expr`),
+# and therefore always falls through to the second. A superinstruction keeps the
+# layout of the first operator, only the opcode byte changes. The second
+# instruction is left in place, so branch targets and instruction sizes are
+# unaffected by fusion.
+#
+
+import yaml
+import argparse
+import os
+import sys
+
+def parse_args():
+	parser = argparse.ArgumentParser(description="ABX superinstruction selector")
+	parser.add_argument("OUT", help="output yaml file")
+	parser.add_argument("--operators", required=True, help="abx_operators.yaml")
+	parser.add_argument("--profile", required=True, help="opcode-sequence profile")
+	parser.add_argument("--count", type=int, default=20, help="max number of superinstructions")
+	return parser.parse_args()
+
+def fusible(first, second):
+	return first is not None and second is not None and "expr" in first
+
+def select(operators, profile, count):
+	by_name = {op["name"]: op for op in operators}
+	free = [code for code in range(255, -1, -1) if code not in {op["code"] for op in operators}]
+
+	ranked = sorted(profile, key=lambda entry: entry["count"], reverse=True)
+	selected = []
+	seen = set()
+
+	for entry in ranked:
+		if len(selected) == count or len(free) == 0:
+			break
+
+		first, second = entry["ops"]
+		if (first, second) in seen:
+			continue
+		if not fusible(by_name.get(first), by_name.get(second)):
+			print("warning: pair not fusible: {} {}".format(first, second), file=sys.stderr)
+			continue
+
+		seen.add((first, second))
+		selected.append({
+			"name": "{}_{}".format(first, second),
+			"code": free.pop(0),
+			"first": first,
+			"second": second,
+			"count": entry["count"],
+		})
+
+	return selected
+
+def main():
+	cfg = parse_args()
+
+	operators = yaml.safe_load(open(cfg.operators, "r"))
+	profile = yaml.safe_load(open(cfg.profile, "r")) or []
+
+	selected = select(operators, profile, cfg.count)
+
+	dirname = os.path.dirname(cfg.OUT)
+	if dirname:
+		os.makedirs(dirname, exist_ok=True)
+
+	with open(cfg.OUT, "w") as out:
+		out.write("# Generated by abx-superinstructions.py. Do not edit.\n")
+		yaml.safe_dump(selected, out, sort_keys=False)
+
+main()
@@ -6,6 +6,7 @@
 #include <Ab/Bytes.hpp>
 #include <cstddef>
 #include <cstring>
+#include <span>
 #include <type_traits>
 
 namespace Ab {
@@ -51,6 +52,19 @@ public:
 		other.size_ = 0;
 	}
 
+	ByteBuffer& operator=(ByteBuffer&& other) noexcept {
+		if (this != &other) {
+			free(data_);
+			data_       = other.data();
+			size_       = other.size();
+			capa_       = other.capacity();
+			other.data_ = nullptr;
+			other.capa_ = 0;
+			other.size_ = 0;
+		}
+		return *this;
+	}
+
 	~ByteBuffer() noexcept {
 		free(data_);
 		data_ = nullptr;
@@ -9,4 +9,17 @@
 #define AB_UNUSED maybe_unused
 #endif
 
+/// Statement attribute, guaranteeing that a call in return position is compiled as a tail call.
+/// Expands to nothing when the compiler can't make that guarantee.
+///
+#if defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::musttail)
+#define AB_MUSTTAIL [[clang::musttail]]
+#endif
+#endif
+
+#ifndef AB_MUSTTAIL
+#define AB_MUSTTAIL
+#endif
+
 #endif  // AB_ATTR_HPP_
@@ -0,0 +1,34 @@
+#ifndef AB_FUTEX_HPP_
+#define AB_FUTEX_HPP_
+
+#include <Ab/Config.hpp>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Ab {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+/// Sleep while the word holds the expected value. May return spuriously, or when the value has
+/// already changed, so callers recheck the word in a loop. The word must only be shared by
+/// threads of this process.
+///
+inline void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept {
+	syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected,
+		nullptr, nullptr, 0);
+}
+
+/// Wake up to count threads sleeping on the word.
+///
+inline void futex_wake(std::atomic<std::uint32_t>& word, int count = INT_MAX) noexcept {
+	syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count,
+		nullptr, nullptr, 0);
+}
+
+}  // namespace Ab
+
+#endif  // AB_FUTEX_HPP_
@@ -1,58 +1,68 @@
-#include <omr/core/Atomic.hpp>
-
-namespace omr {
-
-enum class MemoryOrder { weak, strong; };
-
-template <typename T>
-class Atomic {
+#ifndef AB_LATCH_HPP_
+#define AB_LATCH_HPP_
+
+#include <Ab/Config.hpp>
+#include <Ab/Futex.hpp>
+#include <Ab/Synchronic.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace Ab {
+
+/// A single-use countdown. Threads count the latch down, and waiters are released when it reaches
+/// zero. Waiters spin, then sleep on the count itself, according to their WaitHint. Only the
+/// final count down makes a system call, and only if some waiter is asleep.
+///
+class Latch {
 public:
-	Atomic();
-	~Atomic();
-
-	template <MemoryOrder memoryOrder = MemoryOrder::strong>
-	bool compareAndSwap(const T& x);
-};
-
-template <typename T>
-bool Atomic<T>::compareAndSwap<MemoryOrder::weak>(){
-
+	explicit Latch(std::uint32_t count) noexcept : count_(count) {}
+
+	Latch(const Latch&) = delete;
+
+	~Latch() = default;
+
+	/// Count down by n. The count must not drop below zero.
+	///
+	void count_down(std::uint32_t n = 1) noexcept {
+		// Pairs with the sleeper count in wait. Both are sequentially consistent.
+		if (count_.fetch_sub(n) == n && sleepers_.load() != 0) {
+			futex_wake(count_);
+		}
+	}
+
+	/// True if the count has reached zero.
+	///
+	bool try_wait() const noexcept { return count_.load() == 0; }
+
+	/// Wait for the count to reach zero.
+	///
+	void wait(WaitHint hint = WaitHint::OPTIMIZE_UTILIZATION) const noexcept {
+		if (spin_until([&] { return try_wait(); }, hint)) {
+			return;
+		}
+
+		sleepers_.fetch_add(1);
+		std::uint32_t count = count_.load();
+		while (count != 0) {
+			futex_wait(count_, count);
+			count = count_.load();
+		}
+		sleepers_.fetch_sub(1);
+	}
+
+	/// Count down by n, then wait for the count to reach zero.
+	///
+	void arrive_and_wait(
+		std::uint32_t n = 1, WaitHint hint = WaitHint::OPTIMIZE_UTILIZATION) noexcept {
+		count_down(n);
+		wait(hint);
+	}
+
+private:
+	mutable std::atomic<std::uint32_t> count_;
+	mutable std::atomic<std::uint32_t> sleepers_ = 0;
 };
 
-template <typename T>
-
-namespace Atomic {
-	template <typename T>
-	struct StaticAssertAtomics {};
-
-	template <typename T>
-	{
-		using Assertions = StaticAssertAtomics<T>;
-	};
-}
-atomicCompareAndSwap {
-}
-};  // namespace omr
-
-namespace omr {
-namespace core {
-
-enum class Notify { one, all };
-
-enum class Expect { urgent, delay };
-
-enum class WaitBehaviour { spin, sleep, threeTier, normal };
-
-enum class MemoryOrder {
-
-};
-
-class Futex {};
-
-class Mutex {
-	while (expect)
-};
+}  // namespace Ab
 
-template <typename T>
-}  // namespace core
-}  // namespace omr
+#endif  // AB_LATCH_HPP_
@@ -8,6 +8,12 @@
 
 namespace Ab {
 
+/// Tag for guards which take over access already held by the caller.
+///
+struct AdoptLock {};
+
+inline constexpr AdoptLock ADOPT_LOCK;
+
 /// RAII: Holds a lock for the duration of it's lifetime.
 /// The LockGuard is capable of locking any subclass of SharedLock.
 /// The LockGuard is parameterized on it's access.
@@ -25,8 +31,14 @@ public:
 	/// Obtain shared access on the lock. Cannot fail, but will block.
 	inline explicit LockGuard(LockType & lock);
 
+	/// Take over shared access already held by the caller.
+	inline LockGuard(LockType & lock, AdoptLock) : lock_{lock} {}
+
 	/// Release shared access to the SharedLock.
-	inline ~LockGuard<LockType, Access::SHARED>();
+	inline ~LockGuard();
+
+	/// Not copyable.
+	LockGuard(const LockGuard& other) = delete;
 
 	/// Not copy assignable.
 	LockGuard& operator=(const LockGuard& other) = delete;
@@ -56,9 +68,15 @@ public:
 	/// Obtain exclusive access. Cannot fail, but will block.
 	explicit LockGuard(LockType & lock);
 
+	/// Take over exclusive access already held by the caller.
+	LockGuard(LockType & lock, AdoptLock) : lock_{lock} {}
+
 	/// release exclusive access
 	~LockGuard();
 
+	/// Not copyable.
+	LockGuard(const LockGuard& other) = delete;
+
 	/// Not copy assignable.
 	LockGuard& operator=(const LockGuard& other) = delete;
 
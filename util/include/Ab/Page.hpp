@@ -6,10 +6,17 @@
 #include <Ab/Bytes.hpp>
 #include <Ab/Process.hpp>
 #include <Ab/Result.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <errno.h>
+#include <fcntl.h>
+#include <linux/mempolicy.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <system_error>
 #include <unistd.h>
+#include <utility>
+#include <vector>
 
 namespace Ab {
 
@@ -20,6 +27,72 @@ static const constexpr int READ    = PROT_READ;
 static const constexpr int NONE    = PROT_NONE;
 };  // namespace PagePermission
 
+namespace PageAdvice {
+static const constexpr int WILL_NEED = MADV_WILLNEED;
+static const constexpr int DONT_NEED = MADV_DONTNEED;
+};  // namespace PageAdvice
+
+/// How a mapping is backed by huge pages. Huge pages cover more memory per TLB entry, which cuts
+/// TLB misses over large, randomly accessed mappings.
+///
+enum class HugePages {
+	/// Base pages only.
+	///
+	NONE,
+
+	/// Transparent huge pages. The kernel backs aligned, huge page sized runs of the mapping with
+	/// huge pages as they are touched, if it can.
+	///
+	TRANSPARENT,
+
+	/// Pages from the hugetlbfs pool, reserved by the administrator. Falls back to transparent huge
+	/// pages if the pool can't supply the mapping.
+	///
+	EXPLICIT,
+};
+
+constexpr const char* cstring(HugePages huge_pages) noexcept {
+	switch (huge_pages) {
+	case HugePages::NONE:
+		return "none";
+	case HugePages::TRANSPARENT:
+		return "transparent";
+	case HugePages::EXPLICIT:
+		return "explicit";
+	default:
+		return "unknown";
+	}
+}
+
+/// How pages are placed on NUMA nodes.
+///
+enum class NumaPolicy {
+	/// The kernel's default: each page is allocated on the node of the CPU that first touches it.
+	///
+	DEFAULT,
+
+	/// Prefer a node, falling back to the others when it runs out of memory.
+	///
+	PREFERRED,
+
+	/// Only allocate from a node.
+	///
+	BIND,
+};
+
+constexpr const char* cstring(NumaPolicy policy) noexcept {
+	switch (policy) {
+	case NumaPolicy::DEFAULT:
+		return "default";
+	case NumaPolicy::PREFERRED:
+		return "preferred";
+	case NumaPolicy::BIND:
+		return "bind";
+	default:
+		return "unknown";
+	}
+}
+
 struct PageError : public std::runtime_error {
 	using std::runtime_error::runtime_error;
 };
@@ -31,11 +104,20 @@ public:
 	/// The size of a page. Must be determined at run time.
 	static std::size_t size() noexcept { return Process::properties().page_size(); }
 
+	/// The size of a huge page. Must be determined at run time.
+	static std::size_t huge_size() noexcept { return Process::properties().huge_page_size(); }
+
+	/// Round a size up to a whole number of huge pages.
+	static std::size_t round_to_huge(std::size_t size) noexcept {
+		std::size_t huge = huge_size();
+		return (size + huge - 1) / huge * huge;
+	}
+
 	/// Will bring a page into memory, with no permissions.
 	static MutAddress
 	map(MutAddress address, std::size_t size, int permissions = PagePermission::NONE) {
 		auto p = mmap(to_mut_ptr(address), size, permissions, MAP_ANON | MAP_PRIVATE, 0, 0);
-		if (p == nullptr) {
+		if (p == MAP_FAILED) {
 			throw PageError{"Failed to map pages"};
 		}
 		return to_mut_address(p);
@@ -46,6 +128,23 @@ public:
 		return map(nullptr, size, permissions);
 	}
 
+	/// Map pages at an address aligned to a power-of-two, by over-reserving, and trimming the
+	/// excess from either end. The size must be a whole number of pages.
+	static MutAddress map_aligned(const std::size_t size, const std::size_t alignment,
+		const int permissions = PagePermission::NONE) {
+		auto reservation = map(size + alignment, permissions);
+		auto address     = reinterpret_cast<std::uintptr_t>(reservation);
+		auto aligned     = (address + alignment - 1) & ~std::uintptr_t(alignment - 1);
+		auto head        = aligned - address;
+		if (head != 0) {
+			unmap(reservation, head);
+		}
+		if (alignment - head != 0) {
+			unmap(reservation + head + size, alignment - head);
+		}
+		return reservation + head;
+	}
+
 	/// Unmap a page from memory.
 	/// Returns 0 on success.
 	static void unmap(const MutAddress address, const std::size_t size) {
@@ -62,6 +161,170 @@ public:
 			throw PageError{"Failed to set page permissions"};
 		}
 	}
+
+	/// Replace mapped pages with fresh zeroed pages, and fault them in up front. Without
+	/// MAP_POPULATE, the permissions are set, and the pages are only advised as needed soon.
+	static void
+	populate(const MutAddress address, const std::size_t size, const int permissions) {
+#ifdef MAP_POPULATE
+		auto flags = MAP_ANON | MAP_PRIVATE | MAP_FIXED | MAP_POPULATE;
+		auto p     = mmap(to_mut_ptr(address), size, permissions, flags, -1, 0);
+		if (p == MAP_FAILED) {
+			throw PageError{"Failed to populate pages"};
+		}
+#else
+		set_permissions(address, size, permissions);
+		advise(address, size, PageAdvice::WILL_NEED);
+#endif
+	}
+
+	/// Replace mapped pages with fresh zeroed pages.
+	static void
+	replace(const MutAddress address, const std::size_t size, const int permissions) {
+		auto flags = MAP_ANON | MAP_PRIVATE | MAP_FIXED;
+		auto p     = mmap(to_mut_ptr(address), size, permissions, flags, -1, 0);
+		if (p == MAP_FAILED) {
+			throw PageError{"Failed to replace pages"};
+		}
+	}
+
+	/// Replace mapped pages with a private, copy-on-write mapping of a file. Pages are shared with
+	/// every other private mapping of the file until they are written.
+	static void map_file(const MutAddress address, const std::size_t size, const int permissions,
+		const int fd, const off_t offset = 0) {
+		auto flags = MAP_PRIVATE | MAP_FIXED;
+		auto p     = mmap(to_mut_ptr(address), size, permissions, flags, fd, offset);
+		if (p == MAP_FAILED) {
+			throw PageError{"Failed to map file"};
+		}
+	}
+
+	/// Replace mapped pages with fresh zeroed pages, backed by huge pages. The range must be
+	/// aligned to, and a whole number of, huge pages. Explicit huge pages fall back to transparent
+	/// huge pages, and transparent huge pages are only advised: the kernel may still back the range
+	/// with base pages. See huge_resident_size.
+	static void replace_huge(const MutAddress address, const std::size_t size,
+		const int permissions, const HugePages huge_pages) {
+		if (huge_pages == HugePages::EXPLICIT) {
+			auto flags = MAP_ANON | MAP_PRIVATE | MAP_FIXED | MAP_HUGETLB;
+			auto p     = mmap(to_mut_ptr(address), size, permissions, flags, -1, 0);
+			if (p != MAP_FAILED) {
+				return;
+			}
+		}
+		replace(address, size, permissions);
+		if (huge_pages != HugePages::NONE) {
+			advise_huge(address, size);
+		}
+	}
+
+	/// Advise the OS to back a range with transparent huge pages. The advice is lost if the range
+	/// is mapped over. Returns false if the kernel has no transparent huge page support.
+	static bool advise_huge(const MutAddress address, const std::size_t size) noexcept {
+#ifdef MADV_HUGEPAGE
+		return madvise(to_mut_ptr(address), size, MADV_HUGEPAGE) == 0;
+#else
+		return false;
+#endif
+	}
+
+	/// Set the NUMA policy of a range, through mbind. Pages already allocated are moved to the
+	/// node, if they are not shared. Returns false if the policy can't be set, such as when the
+	/// kernel has no NUMA support. The default policy ignores the node.
+	static bool bind(const MutAddress address, const std::size_t size, const unsigned node,
+		const NumaPolicy policy) noexcept {
+		constexpr std::size_t BITS = 8 * sizeof(unsigned long);
+
+		if (policy == NumaPolicy::DEFAULT) {
+			return syscall(SYS_mbind, address, size, MPOL_DEFAULT, nullptr, 0, 0) == 0;
+		}
+
+		int mode = policy == NumaPolicy::BIND ? MPOL_BIND : MPOL_PREFERRED;
+		std::vector<unsigned long> mask(node / BITS + 1, 0);
+		mask[node / BITS] = 1ul << (node % BITS);
+
+		// The kernel reads one bit less than maxnode.
+
+		auto maxnode = mask.size() * BITS + 1;
+		auto e       = syscall(SYS_mbind, address, size, mode, mask.data(), maxnode, MPOL_MF_MOVE);
+		return e == 0;
+	}
+
+	/// The number of bytes of a range actually backed by huge pages, transparent or explicit, read
+	/// from /proc/self/smaps. Mappings partly inside the range are counted whole. Zero if smaps
+	/// can't be read.
+	static std::size_t huge_resident_size(const Address address, const std::size_t size);
+
+	/// Advise the OS how pages will be used. Discarding pages with PageAdvice::DONT_NEED returns
+	/// them to the OS, and they read as zero when next touched.
+	static void advise(const MutAddress address, const std::size_t size, const int advice) {
+		auto e = madvise(to_mut_ptr(address), size, advice);
+		if (e != 0) {
+			throw PageError{"Failed to advise pages"};
+		}
+	}
+
+	/// Call `f(address, size)` for every run of pages in a range that may have been written since
+	/// they were mapped, according to /proc/self/pagemap. A written page is an anonymous page that
+	/// is resident or swapped out. Pages never touched, and file pages still shared with the page
+	/// cache, are skipped. A page that has only been read may be reported, but a written page is
+	/// never missed. Returns false, having called nothing, if the page map can't be read.
+	template <typename F>
+	static bool for_each_written(const MutAddress address, const std::size_t size, F&& f) {
+		static const int fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+
+		constexpr std::uint64_t PRESENT = std::uint64_t(1) << 63;
+		constexpr std::uint64_t SWAPPED = std::uint64_t(1) << 62;
+		constexpr std::uint64_t FILE    = std::uint64_t(1) << 61;
+
+		constexpr std::size_t CHUNK = 512;
+
+		if (fd < 0) {
+			return false;
+		}
+
+		const std::size_t page_size = Page::size();
+		const std::size_t first     = reinterpret_cast<std::uintptr_t>(address) / page_size;
+		const std::size_t count     = size / page_size;
+
+		// Entries are read a chunk at a time, before any run is reported, so a failed read calls
+		// nothing.
+
+		std::size_t run_start = 0;
+		std::size_t run_size  = 0;
+		std::uint64_t entries[CHUNK];
+		std::vector<std::pair<std::size_t, std::size_t>> runs;
+
+		for (std::size_t i = 0; i < count; i += CHUNK) {
+			std::size_t n     = std::min(CHUNK, count - i);
+			std::size_t bytes = n * sizeof(std::uint64_t);
+			off_t offset      = off_t((first + i) * sizeof(std::uint64_t));
+			if (pread(fd, entries, bytes, offset) != ssize_t(bytes)) {
+				return false;
+			}
+			for (std::size_t j = 0; j < n; ++j) {
+				bool written = (entries[j] & (PRESENT | SWAPPED)) && !(entries[j] & FILE);
+				if (written) {
+					if (run_size == 0) {
+						run_start = i + j;
+					}
+					run_size += 1;
+				} else if (run_size != 0) {
+					runs.emplace_back(run_start, run_size);
+					run_size = 0;
+				}
+			}
+		}
+
+		if (run_size != 0) {
+			runs.emplace_back(run_start, run_size);
+		}
+
+		for (auto [start, n] : runs) {
+			f(address + start * page_size, n * page_size);
+		}
+		return true;
+	}
 };
 
 }  // namespace Ab
@@ -4,19 +4,53 @@
 #include <Ab/Config.hpp>
 #include <cstdlib>
 #include <unistd.h>
+#include <vector>
 
 namespace Ab {
 
 struct SystemProperties {
 public:
-	SystemProperties() : page_size_(sysconf(_SC_PAGESIZE)) {}
+	SystemProperties()
+		: page_size_(sysconf(_SC_PAGESIZE)), huge_page_size_(read_huge_page_size()) {
+		read_numa_topology();
+	}
 
 	/// The memory page size.
 	///
 	std::size_t page_size() const noexcept { return page_size_; }
 
+	/// The size of a huge page, the size mapped by one page-middle-directory entry. Read from
+	/// sysfs, or 2MiB if the kernel doesn't say.
+	///
+	std::size_t huge_page_size() const noexcept { return huge_page_size_; }
+
+	/// One more than the highest NUMA node, read from sysfs. A machine without NUMA has one node,
+	/// holding every CPU.
+	///
+	std::size_t numa_node_count() const noexcept { return node_cpus_.size(); }
+
+	/// The NUMA node a CPU belongs to. Zero for unknown CPUs.
+	///
+	unsigned numa_node_of_cpu(unsigned cpu) const noexcept {
+		return cpu < cpu_nodes_.size() ? cpu_nodes_[cpu] : 0;
+	}
+
+	/// The CPUs of a NUMA node. Empty for unknown nodes, or if the topology couldn't be read.
+	///
+	const std::vector<unsigned>& numa_node_cpus(unsigned node) const noexcept {
+		static const std::vector<unsigned> none;
+		return node < node_cpus_.size() ? node_cpus_[node] : none;
+	}
+
 private:
+	static std::size_t read_huge_page_size() noexcept;
+
+	void read_numa_topology();
+
 	std::size_t page_size_;
+	std::size_t huge_page_size_;
+	std::vector<std::vector<unsigned>> node_cpus_;
+	std::vector<unsigned> cpu_nodes_;
 };
 
 /// Global init and shutdown. Process-wide! Thread unsafe!
@@ -25,6 +59,16 @@ public:
 	/// Obtain the invariant properties of the process.
 	static const SystemProperties& properties() noexcept { return properties_; }
 
+	/// The NUMA node of the CPU the calling thread is running on. The thread may migrate as soon
+	/// as this returns, unless it is pinned.
+	///
+	static unsigned current_numa_node() noexcept;
+
+	/// Restrict the calling thread to the CPUs of a NUMA node. Returns false if the node is
+	/// unknown, or the affinity can't be set.
+	///
+	static bool pin_thread_to_numa_node(unsigned node) noexcept;
+
 private:
 	static SystemProperties properties_;
 };
@@ -3,19 +3,42 @@
 
 #include <Ab/Config.hpp>
 #include <Ab/Access.hpp>
+#include <Ab/Futex.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sched.h>
 
 namespace Ab {
 
 enum class SharedLockError { SUCCESS = 0, FAIL };
 
-/// A classic read-write lock.
-/// SharedLockGuard sharedHeapAccess(heap.lock()); // obtain shared access to the heap
-///   heap.allocate(sharedHeapAccess());
-///   ExclusiveLockGuard exclusiveHeapAccess(heapLock); // upgrade
+/// A reader-biased read-write lock. Taking shared access is cheap, and scales with the number of
+/// CPUs. Taking exclusive access is expensive, and should be rare.
+///
+/// Each reader counts itself in the counter of the CPU it's running on, so readers on different
+/// CPUs never write the same cache line. A writer takes the writer word, which turns new readers
+/// away, then sleeps until the readers already inside have drained. Readers which find a writer
+/// back out, and sleep on the writer word until it's released. Nothing spins: every wait is on a
+/// futex.
+///
+/// A thread may migrate between taking and releasing shared access, so counters are only
+/// meaningful as a sum.
+///
+/// Shared access can't be upgraded. A writer waits for every reader to drain, including a thread
+/// taking exclusive access while it holds shared access, which deadlocks. Release shared access
+/// first, and recheck whatever was read under it.
+///
 class SharedLock {
 public:
+	/// The number of reader counters. CPUs beyond the count share counters.
+	///
+	static constexpr std::size_t SLOT_COUNT = 64;
+
 	SharedLock() noexcept;
 
+	SharedLock(const SharedLock&) = delete;
+
 	~SharedLock() noexcept;
 
 	auto init() noexcept -> SharedLockError;
@@ -28,54 +51,134 @@ public:
 	template <Access access>
 	inline auto unlock() noexcept -> void;
 
+	/// Take access without blocking. Returns false if the lock is held in a conflicting mode, or,
+	/// for exclusive access, while a turned-away reader is backing out.
+	///
+	template <Access access>
+	inline auto tryLock() noexcept -> bool;
+
+	/// True if any thread holds the lock in the given mode. Only a hint, for assertions and tests:
+	/// the answer may be stale by the time it's returned.
+	///
 	template <Access access>
 	inline auto isLocked() const noexcept -> bool;
 
 private:
-	int sharedCount_    = 0;
-	int exclusiveCount_ = 0;
-	// std::mutex mutex_;
-	// atomic<int> sharedCount_;
+	/// States of the writer word.
+	///
+	enum : std::uint32_t { UNLOCKED = 0, LOCKED = 1, CONTENDED = 2 };
+
+	struct alignas(64) Slot {
+		std::atomic<std::int64_t> count = 0;
+	};
+
+	static auto slotIndex() noexcept -> std::size_t {
+		int cpu = sched_getcpu();
+		return cpu < 0 ? 0 : std::size_t(cpu) % SLOT_COUNT;
+	}
+
+	/// Back out of the slot, and let the writer through.
+	///
+	inline auto leave(Slot& slot) noexcept -> void;
+
+	auto lockSharedSlow(Slot& slot) noexcept -> void;
+
+	auto lockExclusiveSlow() noexcept -> void;
+
+	auto waitForReaders() noexcept -> void;
+
+	auto wakeWriter() noexcept -> void;
+
+	auto readerCount() const noexcept -> std::int64_t;
+
+	Slot slots_[SLOT_COUNT];
+
+	/// Held by at most one writer. CONTENDED when readers or writers may be sleeping on it.
+	///
+	alignas(64) std::atomic<std::uint32_t> writer_ = UNLOCKED;
+
+	/// Bumped by readers leaving while a writer holds the lock. The writer sleeps on it.
+	///
+	std::atomic<std::uint32_t> drained_ = 0;
 };
 
 ///
 /// Implementation
 ///
 
+// Every access to the counters and the writer word is sequentially consistent. A reader writes
+// it's counter, then reads the writer word. A writer writes the writer word, then reads the
+// counters. At least one of them sees the other.
+
+inline auto SharedLock::leave(Slot& slot) noexcept -> void {
+	slot.count.fetch_sub(1);
+	if (writer_.load() != UNLOCKED) [[unlikely]] {
+		wakeWriter();
+	}
+}
+
 template <>
 inline auto SharedLock::lock<Access::SHARED>() noexcept -> void {
-	// TODO: Implement
-	sharedCount_ += 1;
-};
+	Slot& slot = slots_[slotIndex()];
+	slot.count.fetch_add(1);
+	if (writer_.load() != UNLOCKED) [[unlikely]] {
+		lockSharedSlow(slot);
+	}
+}
 
 template <>
 inline auto SharedLock::lock<Access::EXCLUSIVE>() noexcept -> void {
-	// TODO: Implement
-	exclusiveCount_ += 1;
+	std::uint32_t expected = UNLOCKED;
+	if (!writer_.compare_exchange_strong(expected, LOCKED)) [[unlikely]] {
+		lockExclusiveSlow();
+	}
+	waitForReaders();
 }
 
 template <>
 inline auto SharedLock::unlock<Access::SHARED>() noexcept -> void {
-	// TODO: Implement
-	sharedCount_ -= 1;
+	leave(slots_[slotIndex()]);
 }
 
 template <>
 inline auto SharedLock::unlock<Access::EXCLUSIVE>() noexcept -> void {
-	// TODO: Implement
-	exclusiveCount_ -= 1;
+	if (writer_.exchange(UNLOCKED) == CONTENDED) {
+		futex_wake(writer_);
+	}
+}
+
+template <>
+inline auto SharedLock::tryLock<Access::SHARED>() noexcept -> bool {
+	Slot& slot = slots_[slotIndex()];
+	slot.count.fetch_add(1);
+	if (writer_.load() != UNLOCKED) {
+		leave(slot);
+		return false;
+	}
+	return true;
+}
+
+template <>
+inline auto SharedLock::tryLock<Access::EXCLUSIVE>() noexcept -> bool {
+	std::uint32_t expected = UNLOCKED;
+	if (!writer_.compare_exchange_strong(expected, LOCKED)) {
+		return false;
+	}
+	if (readerCount() != 0) {
+		unlock<Access::EXCLUSIVE>();
+		return false;
+	}
+	return true;
 }
 
 template <>
 inline auto SharedLock::isLocked<Access::SHARED>() const noexcept -> bool {
-	// TODO: Implement
-	return false;
+	return readerCount() > 0;
 }
 
 template <>
 inline auto SharedLock::isLocked<Access::EXCLUSIVE>() const noexcept -> bool {
-	// TODO: Implement
-	return false;
+	return writer_.load() != UNLOCKED;
 }
 
 }  // namespace Ab
@@ -1,17 +1,158 @@
 #ifndef AB_SYNCHRONIC_HPP_
 #define AB_SYNCHRONIC_HPP_
 
+#include <Ab/Config.hpp>
+#include <Ab/Futex.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
 namespace Ab {
 
+/// How a waiting thread trades CPU time for wake-up latency.
+///
+///   * OPTIMIZE_LATENCY: Spin, then yield, for tens of microseconds before sleeping. A thread
+///     woken within that window sees the change within a cache miss, but burns it's CPU.
+///   * OPTIMIZE_UTILIZATION: Spin briefly, then sleep. A sleeping thread costs nothing, but
+///     takes a futex wake, several microseconds, to come back.
+///
 enum class WaitHint { OPTIMIZE_LATENCY, OPTIMIZE_UTILIZATION };
 
+/// Tell the CPU we are spinning, so it can slow down, and give the core to it's sibling thread.
+///
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+/// Poll done until it returns true, for as long as the hint allows. Returns false if the thread
+/// should go to sleep instead.
+///
+template <typename F>
+bool spin_until(F&& done, WaitHint hint) noexcept {
+	constexpr int SPIN_COUNT      = 64;
+	constexpr int LONG_SPIN_COUNT = 4096;
+	constexpr int YIELD_COUNT     = 64;
+
+	// On a uniprocessor, the thread we wait for can't run while we spin.
+	static const bool multiprocessor = std::thread::hardware_concurrency() > 1;
+
+	int spins = hint == WaitHint::OPTIMIZE_LATENCY ? LONG_SPIN_COUNT : SPIN_COUNT;
+	if (!multiprocessor) {
+		spins = 0;
+	}
+	for (int i = 0; i < spins; ++i) {
+		if (done()) {
+			return true;
+		}
+		cpu_relax();
+	}
+
+	if (hint == WaitHint::OPTIMIZE_LATENCY) {
+		for (int i = 0; i < YIELD_COUNT; ++i) {
+			if (done()) {
+				return true;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	return done();
+}
+
+/// A value which threads can wait on. Waiters spin, then sleep on a futex, according to their
+/// WaitHint. Storing a value wakes every waiter, but only makes a system call when some waiter
+/// is actually asleep, so a handoff to a spinning thread costs a single cache line transfer.
+///
+/// The value itself may be any lock-free atomic type. Sleepers wait on a separate 32-bit epoch,
+/// bumped by every store which finds a sleeper.
+///
 template <typename T>
 class Synchronic {
 public:
 	using Type = T;
 
-	Synchronic();
-	~Synchronic();
+	static_assert(std::is_trivially_copyable_v<T>);
+	static_assert(std::atomic<T>::is_always_lock_free);
+
+	Synchronic() noexcept : Synchronic(T()) {}
+
+	explicit Synchronic(T value) noexcept : value_(value) {}
+
+	Synchronic(const Synchronic&) = delete;
+
+	~Synchronic() = default;
+
+	T load() const noexcept { return value_.load(); }
+
+	/// Store a new value, and wake every waiter.
+	///
+	void store(T value) noexcept {
+		value_.store(value);
+		notify();
+	}
+
+	/// Store a new value, wake every waiter, and return the old value.
+	///
+	T exchange(T value) noexcept {
+		T old = value_.exchange(value);
+		notify();
+		return old;
+	}
+
+	/// Wait until the value is desired.
+	///
+	void wait_for(T desired, WaitHint hint = WaitHint::OPTIMIZE_UTILIZATION) const noexcept {
+		wait([&](T value) { return value == desired; }, hint);
+	}
+
+	/// Wait until the value is not current. Returns the new value.
+	///
+	T wait_for_change(T current, WaitHint hint = WaitHint::OPTIMIZE_UTILIZATION) const noexcept {
+		return wait([&](T value) { return value != current; }, hint);
+	}
+
+private:
+	// The value and the sleeper count are accessed with sequential consistency. A storer writes
+	// the value, then reads the sleeper count. A sleeper writes the sleeper count, then reads the
+	// value. At least one of them sees the other, so a store never misses a sleeper.
+
+	void notify() noexcept {
+		if (sleepers_.load() != 0) [[unlikely]] {
+			epoch_.fetch_add(1);
+			futex_wake(epoch_);
+		}
+	}
+
+	template <typename F>
+	T wait(F&& done, WaitHint hint) const noexcept {
+		T value;
+		if (spin_until([&] { return done(value = value_.load()); }, hint)) {
+			return value;
+		}
+
+		sleepers_.fetch_add(1);
+		while (true) {
+			// Read the epoch before the value. A store after the value was read bumps the epoch,
+			// and the futex wait returns at once.
+			std::uint32_t epoch = epoch_.load();
+			value               = value_.load();
+			if (done(value)) {
+				break;
+			}
+			futex_wait(epoch_, epoch);
+		}
+		sleepers_.fetch_sub(1);
+		return value;
+	}
+
+	std::atomic<T> value_;
+	mutable std::atomic<std::uint32_t> sleepers_ = 0;
+	mutable std::atomic<std::uint32_t> epoch_    = 0;
 };
 
 }  // namespace Ab
@@ -0,0 +1,163 @@
+#ifndef AB_WORKSTEALINGDEQUE_HPP_
+#define AB_WORKSTEALINGDEQUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace Ab {
+
+/// A Chase-Lev work-stealing deque. The owning thread pushes and pops at the bottom, like a stack,
+/// while any other thread may steal from the top, like a queue. The owner only synchronizes with
+/// thieves when the deque is nearly empty.
+///
+/// The memory orderings follow Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient
+/// Work-Stealing for Weak Memory Models", PPoPP 2013.
+///
+/// The ring buffer doubles when full. A thief may still be reading an old buffer, so old buffers
+/// are kept until the deque is destroyed. The deque only grows, so at most half the memory is
+/// retired.
+///
+template <typename T>
+class WorkStealingDeque {
+public:
+	static_assert(std::is_trivially_copyable_v<T>);
+
+	static constexpr std::size_t DEFAULT_CAPACITY = 64;
+
+	/// A deque with room for capacity elements before growing. The capacity must be a power of
+	/// two.
+	///
+	explicit WorkStealingDeque(std::size_t capacity = DEFAULT_CAPACITY)
+		: top_(0), bottom_(0), buffer_(nullptr) {
+		buffers_.push_back(std::make_unique<Buffer>(capacity));
+		buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	/// Push an element onto the bottom. Owner only.
+	///
+	void push(T x) {
+		std::int64_t b = bottom_.load(std::memory_order_relaxed);
+		std::int64_t t = top_.load(std::memory_order_acquire);
+		Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+		if (b - t > buffer->mask) {
+			buffer = grow(buffer, t, b);
+		}
+		buffer->put(b, x);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom_.store(b + 1, std::memory_order_relaxed);
+	}
+
+	/// Pop the most recently pushed element from the bottom. Owner only.
+	///
+	std::optional<T> pop() noexcept {
+		std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+		Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+		bottom_.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top_.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			// Empty.
+			bottom_.store(b + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+
+		std::optional<T> x = buffer->get(b);
+		if (t == b) {
+			// The last element, which a thief may be taking at the same time.
+			if (!top_.compare_exchange_strong(
+					t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				x = std::nullopt;
+			}
+			bottom_.store(b + 1, std::memory_order_relaxed);
+		}
+		return x;
+	}
+
+	/// Take the least recently pushed element from the top. Any thread. Returns nothing if the
+	/// deque is empty, or another thread took the element first.
+	///
+	std::optional<T> steal() noexcept {
+		std::int64_t t = top_.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t b = bottom_.load(std::memory_order_acquire);
+
+		if (t >= b) {
+			return std::nullopt;
+		}
+
+		// Consume ordering, strengthened to acquire.
+		Buffer* buffer = buffer_.load(std::memory_order_acquire);
+		T x            = buffer->get(t);
+		if (!top_.compare_exchange_strong(
+				t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return std::nullopt;
+		}
+		return x;
+	}
+
+	/// The number of elements. Only a hint, when other threads are pushing or stealing.
+	///
+	std::size_t size() const noexcept {
+		std::int64_t b = bottom_.load(std::memory_order_relaxed);
+		std::int64_t t = top_.load(std::memory_order_relaxed);
+		return b > t ? std::size_t(b - t) : 0;
+	}
+
+	bool empty() const noexcept { return size() == 0; }
+
+	/// The number of elements the deque can hold before growing.
+	///
+	std::size_t capacity() const noexcept {
+		return std::size_t(buffer_.load(std::memory_order_relaxed)->mask + 1);
+	}
+
+private:
+	/// A ring buffer, indexed by the unbounded top and bottom positions.
+	///
+	struct Buffer {
+		explicit Buffer(std::size_t capacity)
+			: mask(std::int64_t(capacity) - 1), slots(new std::atomic<T>[capacity]) {}
+
+		T get(std::int64_t i) const noexcept {
+			return slots[i & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(std::int64_t i, T x) noexcept {
+			slots[i & mask].store(x, std::memory_order_relaxed);
+		}
+
+		std::int64_t mask;
+		std::unique_ptr<std::atomic<T>[]> slots;
+	};
+
+	Buffer* grow(Buffer* buffer, std::int64_t t, std::int64_t b) {
+		auto bigger = std::make_unique<Buffer>(std::size_t(buffer->mask + 1) * 2);
+		for (std::int64_t i = t; i < b; ++i) {
+			bigger->put(i, buffer->get(i));
+		}
+		buffers_.push_back(std::move(bigger));
+		buffer = buffers_.back().get();
+		buffer_.store(buffer, std::memory_order_release);
+		return buffer;
+	}
+
+	// Thieves write top, and the owner writes bottom. Keep them on separate cache lines.
+	alignas(64) std::atomic<std::int64_t> top_;
+	alignas(64) std::atomic<std::int64_t> bottom_;
+	std::atomic<Buffer*> buffer_;
+	std::vector<std::unique_ptr<Buffer>> buffers_;  ///< Every buffer, owner only.
+};
+
+}  // namespace Ab
+
+#endif  // AB_WORKSTEALINGDEQUE_HPP_
@@ -0,0 +1,44 @@
+#include <Ab/Page.hpp>
+#include <cstdio>
+#include <cstring>
+
+namespace Ab {
+
+std::size_t Page::huge_resident_size(const Address address, const std::size_t size) {
+	std::FILE* file = std::fopen("/proc/self/smaps", "r");
+	if (file == nullptr) {
+		return 0;
+	}
+
+	const auto first = reinterpret_cast<std::uintptr_t>(address);
+	const auto last  = first + size;
+
+	// smaps is a header line per mapping, "start-end perms ...", followed by "Field: value kB"
+	// lines describing it.
+
+	std::size_t total = 0;
+	bool inside       = false;
+	char line[512];
+
+	while (std::fgets(line, sizeof(line), file) != nullptr) {
+		unsigned long long start = 0;
+		unsigned long long end   = 0;
+		unsigned long long kb    = 0;
+		char field[64];
+
+		if (std::sscanf(line, "%llx-%llx ", &start, &end) == 2) {
+			inside = start < last && first < end;
+		} else if (inside && std::sscanf(line, "%63[^:]: %llu kB", field, &kb) == 2) {
+			if (std::strcmp(field, "AnonHugePages") == 0
+				|| std::strcmp(field, "Private_Hugetlb") == 0
+				|| std::strcmp(field, "Shared_Hugetlb") == 0) {
+				total += std::size_t(kb) * 1024;
+			}
+		}
+	}
+
+	std::fclose(file);
+	return total;
+}
+
+}  // namespace Ab
@@ -1,7 +1,104 @@
 #include <Ab/Process.hpp>
+#include <cstdio>
+#include <sched.h>
+#include <string>
 
 namespace Ab {
 
+std::size_t SystemProperties::read_huge_page_size() noexcept {
+	std::size_t size = std::size_t(2) * 1024 * 1024;
+	if (std::FILE* file = std::fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r")) {
+		unsigned long long value = 0;
+		if (std::fscanf(file, "%llu", &value) == 1 && value != 0) {
+			size = std::size_t(value);
+		}
+		std::fclose(file);
+	}
+	return size;
+}
+
+/// Parse a sysfs CPU or node list, such as "0-3,8,10-11".
+///
+static std::vector<unsigned> read_cpu_list(const std::string& path) {
+	std::vector<unsigned> cpus;
+	std::FILE* file = std::fopen(path.c_str(), "r");
+	if (file == nullptr) {
+		return cpus;
+	}
+
+	unsigned first = 0;
+	while (std::fscanf(file, "%u", &first) == 1) {
+		unsigned last = first;
+		int c         = std::fgetc(file);
+		if (c == '-') {
+			if (std::fscanf(file, "%u", &last) != 1) {
+				break;
+			}
+			c = std::fgetc(file);
+		}
+		for (unsigned cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+		if (c != ',') {
+			break;
+		}
+	}
+
+	std::fclose(file);
+	return cpus;
+}
+
+void SystemProperties::read_numa_topology() {
+	// Node numbers may have gaps. A node that is offline, or has no CPUs, has an empty CPU list.
+
+	for (unsigned node : read_cpu_list("/sys/devices/system/node/online")) {
+		auto path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+		auto cpus = read_cpu_list(path);
+		for (unsigned cpu : cpus) {
+			if (cpu_nodes_.size() <= cpu) {
+				cpu_nodes_.resize(cpu + 1, 0);
+			}
+			cpu_nodes_[cpu] = node;
+		}
+		if (node_cpus_.size() <= node) {
+			node_cpus_.resize(node + 1);
+		}
+		node_cpus_[node] = std::move(cpus);
+	}
+
+	// Without NUMA, every CPU is on node zero.
+
+	if (node_cpus_.empty()) {
+		std::vector<unsigned> cpus;
+		long count = sysconf(_SC_NPROCESSORS_CONF);
+		for (long cpu = 0; cpu < count; ++cpu) {
+			cpus.push_back(unsigned(cpu));
+		}
+		node_cpus_.push_back(std::move(cpus));
+	}
+}
+
 SystemProperties Process::properties_;
 
+unsigned Process::current_numa_node() noexcept {
+	int cpu = sched_getcpu();
+	return cpu < 0 ? 0 : properties_.numa_node_of_cpu(unsigned(cpu));
+}
+
+bool Process::pin_thread_to_numa_node(unsigned node) noexcept {
+	const auto& cpus = properties_.numa_node_cpus(node);
+	if (cpus.empty()) {
+		return false;
+	}
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (unsigned cpu : cpus) {
+		if (cpu < CPU_SETSIZE) {
+			CPU_SET(cpu, &set);
+		}
+	}
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
 }  // namespace Ab
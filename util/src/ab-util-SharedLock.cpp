@@ -4,10 +4,8 @@
 
 namespace Ab {
 
-// TODO(rwy0717): Implement
 SharedLock::SharedLock() noexcept = default;
 
-// TODO(rwy0717): Implement
 SharedLock::~SharedLock() noexcept = default;
 
 auto SharedLock::init() noexcept -> SharedLockError {
@@ -20,4 +18,58 @@ auto SharedLock::kill() noexcept -> SharedLockError {
 	return SharedLockError::SUCCESS;
 }
 
+auto SharedLock::lockSharedSlow(Slot& slot) noexcept -> void {
+	while (true) {
+		leave(slot);
+
+		// Sleep until the writer is gone, flagging that it must wake us when it leaves.
+		std::uint32_t writer = writer_.load();
+		while (writer != UNLOCKED) {
+			if (writer == LOCKED && !writer_.compare_exchange_weak(writer, CONTENDED)) {
+				continue;
+			}
+			futex_wait(writer_, CONTENDED);
+			writer = writer_.load();
+		}
+
+		slot.count.fetch_add(1);
+		if (writer_.load() == UNLOCKED) {
+			return;
+		}
+	}
+}
+
+auto SharedLock::lockExclusiveSlow() noexcept -> void {
+	// Once contended, the word stays contended until unlocked, since we can't tell whether other
+	// threads still sleep on it.
+	while (writer_.exchange(CONTENDED) != UNLOCKED) {
+		futex_wait(writer_, CONTENDED);
+	}
+}
+
+auto SharedLock::waitForReaders() noexcept -> void {
+	// Read the sequence before the counters. A reader leaving after we read the counters bumps
+	// the sequence, and the wait returns at once.
+	while (true) {
+		std::uint32_t seen = drained_.load();
+		if (readerCount() == 0) {
+			return;
+		}
+		futex_wait(drained_, seen);
+	}
+}
+
+auto SharedLock::wakeWriter() noexcept -> void {
+	drained_.fetch_add(1);
+	futex_wake(drained_);
+}
+
+auto SharedLock::readerCount() const noexcept -> std::int64_t {
+	std::int64_t count = 0;
+	for (const Slot& slot : slots_) {
+		count += slot.count.load();
+	}
+	return count;
+}
+
 }  // namespace Ab
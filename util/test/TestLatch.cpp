@@ -0,0 +1,44 @@
+#include <Ab/Config.hpp>
+#include <Ab/Latch.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Ab;
+
+TEST(Latch, countDown) {
+	Latch latch(2);
+	EXPECT_FALSE(latch.try_wait());
+	latch.count_down();
+	EXPECT_FALSE(latch.try_wait());
+	latch.count_down();
+	EXPECT_TRUE(latch.try_wait());
+	latch.wait();
+}
+
+/// Nobody passes the latch before everybody has arrived.
+///
+TEST(Latch, arriveAndWait) {
+	for (auto hint : {WaitHint::OPTIMIZE_LATENCY, WaitHint::OPTIMIZE_UTILIZATION}) {
+		constexpr std::uint32_t COUNT = 8;
+		Latch latch(COUNT);
+		std::atomic<std::uint32_t> arrived = 0;
+		std::atomic<bool> early            = false;
+
+		std::vector<std::thread> threads;
+		for (std::uint32_t i = 0; i < COUNT; ++i) {
+			threads.emplace_back([&] {
+				arrived += 1;
+				latch.arrive_and_wait(1, hint);
+				if (arrived != COUNT) {
+					early = true;
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		EXPECT_FALSE(early);
+	}
+}
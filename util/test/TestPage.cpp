@@ -14,3 +14,53 @@ TEST(page, map_one_page) {
 	EXPECT_NE(addr, nullptr);
 	Page::unmap(addr, size);
 }
+
+TEST(page, for_each_written) {
+	auto size = Page::size();
+	auto addr = Page::map(size * 8, PagePermission::READ | PagePermission::WRITE);
+
+	addr[size * 2] = 1;
+	addr[size * 3] = 1;
+	addr[size * 6] = 1;
+
+	std::vector<std::pair<MutAddress, std::size_t>> runs;
+	auto found = Page::for_each_written(addr, size * 8, [&](MutAddress a, std::size_t n) {
+		runs.emplace_back(a, n);
+	});
+
+	if (found) {
+		ASSERT_EQ(runs.size(), 2);
+		EXPECT_EQ(runs[0].first, addr + size * 2);
+		EXPECT_EQ(runs[0].second, size * 2);
+		EXPECT_EQ(runs[1].first, addr + size * 6);
+		EXPECT_EQ(runs[1].second, size);
+	}
+
+	Page::unmap(addr, size * 8);
+}
+
+TEST(page, map_aligned) {
+	auto huge = Page::huge_size();
+	auto addr = Page::map_aligned(huge, huge, PagePermission::READ | PagePermission::WRITE);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(addr) % huge, 0);
+	addr[0]        = 1;
+	addr[huge - 1] = 1;
+	Page::unmap(addr, huge);
+}
+
+TEST(page, replace_huge) {
+	auto huge        = Page::huge_size();
+	auto permissions = PagePermission::READ | PagePermission::WRITE;
+	auto addr        = Page::map_aligned(huge * 2, huge);
+
+	for (auto huge_pages : {HugePages::NONE, HugePages::TRANSPARENT, HugePages::EXPLICIT}) {
+		Page::replace_huge(addr, huge * 2, permissions, huge_pages);
+		for (std::size_t i = 0; i < huge * 2; i += Page::size()) {
+			EXPECT_EQ(addr[i], 0);
+			addr[i] = 1;
+		}
+		EXPECT_LE(Page::huge_resident_size(addr, huge * 2), huge * 2);
+	}
+
+	Page::unmap(addr, huge * 2);
+}
@@ -2,6 +2,10 @@
 #include <Ab/LockGuard.hpp>
 #include <Ab/SharedLock.hpp>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace Ab;
 
@@ -11,13 +15,20 @@ TEST(SharedLock, multipleShared) {
 	EXPECT_TRUE(trySharedLock(lock));
 }
 
-TEST(SharedLock, DISABLED_failToTakeExclusive) {
+TEST(SharedLock, failToTakeExclusive) {
 	SharedLock lock;
 	SharedLockGuard<SharedLock> shared(lock);
 	EXPECT_FALSE(tryExclusiveLock(lock));
 }
 
-TEST(SharedLock, DISABLED_exclusiveThenShared) {
+TEST(SharedLock, failToTakeShared) {
+	SharedLock lock;
+	ExclusiveLockGuard<SharedLock> exclusive(lock);
+	EXPECT_FALSE(trySharedLock(lock));
+	EXPECT_FALSE(tryExclusiveLock(lock));
+}
+
+TEST(SharedLock, exclusiveThenShared) {
 	SharedLock lock;
 	{
 		ExclusiveLockGuard<SharedLock> exclusive(lock);
@@ -30,3 +41,60 @@ TEST(SharedLock, DISABLED_exclusiveThenShared) {
 	}
 	EXPECT_FALSE(lock.isLocked<Access::SHARED>());
 }
+
+TEST(SharedLock, writerWaitsForReaders) {
+	SharedLock lock;
+	std::atomic<bool> written = false;
+
+	std::thread writer;
+	{
+		SharedLockGuard<SharedLock> shared(lock);
+		writer = std::thread([&] {
+			ExclusiveLockGuard<SharedLock> exclusive(lock);
+			written = true;
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		EXPECT_FALSE(written);
+	}
+	writer.join();
+	EXPECT_TRUE(written);
+}
+
+/// Writers update a pair non-atomically. Readers must never see it half written.
+///
+TEST(SharedLock, readersNeverSeeWriters) {
+	SharedLock lock;
+	std::uint64_t a = 0;
+	std::uint64_t b = 0;
+	std::atomic<bool> torn = false;
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&] {
+			for (int j = 0; j < 20000; ++j) {
+				SharedLockGuard<SharedLock> shared(lock);
+				if (a != b) {
+					torn = true;
+				}
+			}
+		});
+	}
+	for (int i = 0; i < 2; ++i) {
+		threads.emplace_back([&] {
+			for (int j = 0; j < 2000; ++j) {
+				ExclusiveLockGuard<SharedLock> exclusive(lock);
+				a += 1;
+				b += 1;
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_FALSE(torn);
+	EXPECT_EQ(a, 4000u);
+	EXPECT_EQ(b, 4000u);
+	EXPECT_FALSE(lock.isLocked<Access::SHARED>());
+	EXPECT_FALSE(lock.isLocked<Access::EXCLUSIVE>());
+}
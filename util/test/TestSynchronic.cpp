@@ -0,0 +1,47 @@
+#include <Ab/Config.hpp>
+#include <Ab/Synchronic.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace Ab;
+
+TEST(Synchronic, waitForValueAlreadyThere) {
+	Synchronic<int> x(3);
+	x.wait_for(3);
+	EXPECT_EQ(x.wait_for_change(4), 3);
+}
+
+TEST(Synchronic, wakeSleeper) {
+	for (auto hint : {WaitHint::OPTIMIZE_LATENCY, WaitHint::OPTIMIZE_UTILIZATION}) {
+		Synchronic<int> x(0);
+		std::thread waiter([&] { x.wait_for(1, hint); });
+		// Long enough for the waiter to fall asleep.
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		x.store(1);
+		waiter.join();
+		EXPECT_EQ(x.load(), 1);
+	}
+}
+
+/// Two threads hand a counter back and forth. Every handoff must be seen.
+///
+TEST(Synchronic, pingPong) {
+	for (auto hint : {WaitHint::OPTIMIZE_LATENCY, WaitHint::OPTIMIZE_UTILIZATION}) {
+		constexpr std::uint64_t COUNT = 10000;
+		Synchronic<std::uint64_t> x(0);
+
+		std::thread odd([&] {
+			for (std::uint64_t i = 1; i < COUNT; i += 2) {
+				x.wait_for(i, hint);
+				x.store(i + 1);
+			}
+		});
+		for (std::uint64_t i = 0; i < COUNT; i += 2) {
+			x.wait_for(i, hint);
+			x.store(i + 1);
+		}
+		odd.join();
+		EXPECT_EQ(x.load(), COUNT);
+	}
+}
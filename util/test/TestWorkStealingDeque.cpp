@@ -0,0 +1,89 @@
+#include <Ab/WorkStealingDeque.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Ab;
+
+TEST(TestWorkStealingDeque, PopIsLastInFirstOut) {
+	WorkStealingDeque<int> deque;
+	EXPECT_TRUE(deque.empty());
+	EXPECT_EQ(deque.pop(), std::nullopt);
+
+	deque.push(1);
+	deque.push(2);
+	deque.push(3);
+	EXPECT_EQ(deque.size(), 3);
+	EXPECT_EQ(deque.pop(), 3);
+	EXPECT_EQ(deque.pop(), 2);
+	EXPECT_EQ(deque.pop(), 1);
+	EXPECT_EQ(deque.pop(), std::nullopt);
+	EXPECT_TRUE(deque.empty());
+}
+
+TEST(TestWorkStealingDeque, StealIsFirstInFirstOut) {
+	WorkStealingDeque<int> deque;
+	deque.push(1);
+	deque.push(2);
+	deque.push(3);
+	EXPECT_EQ(deque.steal(), 1);
+	EXPECT_EQ(deque.steal(), 2);
+	EXPECT_EQ(deque.pop(), 3);
+	EXPECT_EQ(deque.steal(), std::nullopt);
+}
+
+TEST(TestWorkStealingDeque, Grow) {
+	WorkStealingDeque<int> deque(4);
+	for (int i = 0; i < 100; ++i) {
+		deque.push(i);
+	}
+	EXPECT_GE(deque.capacity(), 100);
+	EXPECT_EQ(deque.steal(), 0);
+	for (int i = 99; i > 0; --i) {
+		EXPECT_EQ(deque.pop(), i);
+	}
+	EXPECT_TRUE(deque.empty());
+}
+
+/// The owner pushes and pops while thieves steal. Every element is taken exactly once.
+///
+TEST(TestWorkStealingDeque, ConcurrentSteal) {
+	constexpr int COUNT   = 100000;
+	constexpr int THIEVES = 3;
+
+	WorkStealingDeque<int> deque(8);
+	std::vector<std::atomic<int>> taken(COUNT);
+	std::atomic<bool> done = false;
+
+	std::vector<std::thread> thieves;
+	for (int i = 0; i < THIEVES; ++i) {
+		thieves.emplace_back([&] {
+			while (!done.load() || !deque.empty()) {
+				if (auto x = deque.steal()) {
+					taken[*x].fetch_add(1);
+				}
+			}
+		});
+	}
+
+	for (int i = 0; i < COUNT; ++i) {
+		deque.push(i);
+		if (i % 3 == 0) {
+			if (auto x = deque.pop()) {
+				taken[*x].fetch_add(1);
+			}
+		}
+	}
+	done = true;
+
+	for (auto& thief : thieves) {
+		thief.join();
+	}
+
+	for (int i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(taken[i].load(), 1) << i;
+	}
+}